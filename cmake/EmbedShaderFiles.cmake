@@ -0,0 +1,65 @@
+# Script mode part of embed_shaders (EmbedShaders.cmake): writes OUTPUT with the SOURCES and the SPIR-V MODULES (both
+# separated by |, MODULES empty or one per source) as constexpr arrays.
+
+string(REPLACE "|" ";" SOURCES "${SOURCES}")
+string(REPLACE "|" ";" MODULES "${MODULES}")
+
+# The bytes of a file as lines of "0x.., " (16 per line), optionally with a terminating zero
+function(bytes_of file terminate result)
+    file(READ ${file} hex HEX)
+    if (terminate)
+        string(APPEND hex "00")
+    endif ()
+    string(LENGTH "${hex}" length)
+    set(lines)
+    set(offset 0)
+    while (offset LESS length)
+        string(SUBSTRING "${hex}" ${offset} 32 chunk)
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1, " chunk "${chunk}")
+        string(STRIP "${chunk}" chunk)
+        list(APPEND lines "    ${chunk}")
+        math(EXPR offset "${offset} + 32")
+    endwhile ()
+    string(JOIN "\n" text ${lines})
+    set(${result} "${text}" PARENT_SCOPE)
+endfunction()
+
+# pyramid.vert -> pyramidVert
+function(variable_of file result)
+    get_filename_component(name ${file} NAME)
+    string(REGEX MATCHALL "[A-Za-z0-9]+" parts ${name})
+    set(variable)
+    foreach (part ${parts})
+        if (variable)
+            string(SUBSTRING ${part} 0 1 first)
+            string(SUBSTRING ${part} 1 -1 rest)
+            string(TOUPPER ${first} first)
+            set(part ${first}${rest})
+        endif ()
+        string(APPEND variable ${part})
+    endforeach ()
+    set(${result} ${variable} PARENT_SCOPE)
+endfunction()
+
+set(text "// Generated by embed_shaders (cmake/EmbedShaders.cmake), edit the shader files instead\n#pragma once\n")
+if (MODULES)
+    string(APPEND text "\n#define EMBEDDED_SHADERS_SPIRV\n")
+endif ()
+
+list(LENGTH SOURCES count)
+math(EXPR last "${count} - 1")
+foreach (index RANGE ${last})
+    list(GET SOURCES ${index} source)
+    variable_of(${source} variable)
+    get_filename_component(name ${source} NAME)
+    bytes_of(${source} TRUE bytes)
+    string(APPEND text "\n// ${name}\nconstexpr unsigned char ${variable}[] = {\n${bytes}\n};\n")
+    if (MODULES)
+        list(GET MODULES ${index} module)
+        bytes_of(${module} FALSE bytes)
+        string(APPEND text "alignas(4) constexpr unsigned char ${variable}Spirv[] = {\n${bytes}\n};\n")
+    endif ()
+endforeach ()
+
+# Unchanged contents keep the old timestamp, nothing that includes it is rebuilt
+file(CONFIGURE OUTPUT ${OUTPUT} CONTENT "${text}" @ONLY)
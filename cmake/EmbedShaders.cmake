@@ -0,0 +1,94 @@
+# Build-time shader handling: embed_shaders(<target> <header> [UNCHECKED] <files...>)
+#
+# Generates <header> for the target with every shader file as a constexpr array, named after the file in camel case
+# (resources/shaders/pyramid.vert -> pyramidVert). The GLSL source is zero-terminated, reinterpret_cast makes it the
+# const char* of a source. With SHADERS_SPIRV the file is compiled to a SPIR-V module for
+# glShaderBinary / glSpecializeShader (OpenGL 4.6) as well, pyramidVertSpirv, and the header defines
+# EMBEDDED_SHADERS_SPIRV.
+#
+# Every file goes through glslangValidator first (stage from the extension: .vert, .frag, .comp, ...), a shader that
+# doesn't compile fails the build instead of the start of the program. Without glslangValidator the files are embedded
+# unchecked. UNCHECKED skips the check (and SPIR-V) for files that only compile after ShaderPreprocessor has expanded
+# their #include lines and injected the defines, those are checked expanded instead (validate_shader_command).
+#
+# validate_shaders(<target> <files...>) runs the same check over shader files that <target> reads at runtime.
+
+option(SHADERS_VALIDATE "Validate the shader files with glslangValidator at build time" ON)
+option(SHADERS_SPIRV "Compile the shader files to SPIR-V and embed the modules" OFF)
+
+find_program(GLSLANG_VALIDATOR NAMES glslangValidator glslang)
+if (NOT GLSLANG_VALIDATOR)
+    if (SHADERS_SPIRV)
+        message(WARNING "glslangValidator not found, embedding the shaders without SPIR-V")
+    elseif (SHADERS_VALIDATE)
+        message(STATUS "glslangValidator not found, shaders are not validated at build time")
+    endif ()
+endif ()
+
+set(EMBED_SHADER_FILES_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/EmbedShaderFiles.cmake)
+
+function(embed_shaders target header)
+    cmake_parse_arguments(PARSE_ARGV 2 EMBED "UNCHECKED" "" "")
+    set(output ${CMAKE_CURRENT_BINARY_DIR}/embedded/${header})
+    file(MAKE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/embedded)
+    set(commands)
+    set(sources)
+    set(modules)
+    foreach (file ${EMBED_UNPARSED_ARGUMENTS})
+        get_filename_component(path ${file} ABSOLUTE)
+        get_filename_component(name ${file} NAME)
+        list(APPEND sources ${path})
+        if (EMBED_UNCHECKED)
+            continue()
+        elseif (GLSLANG_VALIDATOR AND SHADERS_SPIRV)
+            # -G compiles for OpenGL, which validates as well
+            set(module ${CMAKE_CURRENT_BINARY_DIR}/embedded/${name}.spv)
+            list(APPEND modules ${module})
+            list(APPEND commands COMMAND ${GLSLANG_VALIDATOR} -G --auto-map-locations -o ${module} ${path})
+        elseif (GLSLANG_VALIDATOR AND SHADERS_VALIDATE)
+            list(APPEND commands COMMAND ${GLSLANG_VALIDATOR} ${path})
+        endif ()
+    endforeach ()
+
+    # Lists can't be passed through -D, they go with | instead of ;
+    string(REPLACE ";" "|" sourceList "${sources}")
+    string(REPLACE ";" "|" moduleList "${modules}")
+    add_custom_command(
+            OUTPUT ${output}
+            ${commands}
+            COMMAND ${CMAKE_COMMAND} -DOUTPUT=${output} -DSOURCES=${sourceList} -DMODULES=${moduleList}
+                    -P ${EMBED_SHADER_FILES_SCRIPT}
+            DEPENDS ${sources} ${EMBED_SHADER_FILES_SCRIPT}
+            COMMENT "Validating and embedding ${header}"
+            VERBATIM)
+    target_sources(${target} PRIVATE ${output})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR}/embedded)
+endfunction()
+
+# The glslangValidator check of <file> as commands for add_custom_command (with GLSLANG_VALIDATOR and SHADERS_VALIDATE).
+# Only a successful check creates <stamp>, so a failed one runs again on the next build.
+function(validate_shader_command variable file stamp)
+    set(${variable} COMMAND ${GLSLANG_VALIDATOR} ${file} COMMAND ${CMAKE_COMMAND} -E touch ${stamp} PARENT_SCOPE)
+endfunction()
+
+function(validate_shaders target)
+    if (NOT GLSLANG_VALIDATOR OR NOT SHADERS_VALIDATE)
+        return()
+    endif ()
+    file(MAKE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/validated/${target})
+    set(stamps)
+    foreach (file ${ARGN})
+        get_filename_component(path ${file} ABSOLUTE)
+        get_filename_component(name ${file} NAME)
+        set(stamp ${CMAKE_CURRENT_BINARY_DIR}/validated/${target}/${name}.stamp)
+        validate_shader_command(commands ${path} ${stamp})
+        add_custom_command(
+                OUTPUT ${stamp}
+                ${commands}
+                DEPENDS ${path}
+                COMMENT "Validating ${name}"
+                VERBATIM)
+        list(APPEND stamps ${stamp})
+    endforeach ()
+    target_sources(${target} PRIVATE ${stamps})
+endfunction()
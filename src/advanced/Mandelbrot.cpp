@@ -1,229 +1,802 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <ComputeMandelbrot.hpp>
+#include <DeepZoom.hpp>
+#include <FileWatcher.hpp>
+#include <FractalPrograms.hpp>
+#include <FrameCapture.hpp>
+#include <FullScreenQuad.hpp>
+#include <HeadlessContext.hpp>
+#include <IterationBudget.hpp>
+#include <MandelbrotPrograms.hpp>
+#include <MandelbrotShaders.hpp>
+#include <MandelbrotView.hpp>
+#include <Palette.hpp>
+#include <ProgramCache.hpp>
+#include <ProgressiveRenderer.hpp>
+#include <ShaderBuildQueue.hpp>
+#include <ShaderUtils.hpp>
+#include <UniformBuffer.hpp>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <thread>
 
+// Usage: Mandelbrot [--headless] [--size W H] [--output image.ppm] [--center X Y] [--scale S] [--iterations N]
+//                   [--no-progressive] [--precision df64|double] [--brute-force] [--capture prefix]
+//                   [--capture-format png|qoi|raw] [--palette NAME] [--palette-length N] [--auto-iterations]
+//                   [--frame-target MS] [--compute] [--border-fill] [--no-bla] [--distance] [--supersample N]
+//                   [--supersample-threshold PIXELS] [--formula mandelbrot|julia] [--power N] [--julia X Y]
+//                   [--shader-cache DIR] [--no-shader-cache] [--clear-shader-cache] [--shader-directory DIR]
+//
+// --headless renders without a window through EGL (no display or GPU needed). The frame loop runs until the image is
+// complete, then writes it to --output (default mandelbrot.ppm) and exits.
+// --center keeps every digit it is given (see BigFloat::parse), the center and scale are printed on exit to come back
+// to the view.
+// --capture records every rendered frame to prefix000000.png, prefix000001.png, ... from the start, C starts and stops
+// recording at any time (prefix "capture_" unless given).
+// --palette picks the start palette (classic, fire, ocean or gray), L cycles through them. --palette-length is the
+// number of iterations per pass through the palette, 0 gives the plain gray iteration count.
+// --auto-iterations (A toggles) sets the iteration limit from a coarse sample pass after every view change, see
+// IterationBudget. The limit, the escape statistics and the estimated frame time go to the window title and the log.
+// --frame-target is the GPU time a full frame may take in that mode (default 100 ms).
+// --compute (G toggles) renders single precision with the compute shader path (OpenGL 4.3) instead of the fragment
+// shader, see ComputeMandelbrot. --border-fill lets it fill tiles whose border doesn't escape, faster but approximate.
+// --no-bla (B toggles) makes the perturbation shader iterate every step instead of skipping ahead with the bilinear
+// approximation table of the reference orbit, see DeepZoom.
+// --distance (E toggles) shades by the estimated distance to the boundary instead of the escape time, in float, df64
+// and double. Pixels closer to the boundary than --supersample-threshold pixels (default 2) are sampled again on an
+// N x N grid (--supersample, 1 to 8, default 4, 1 turns it off).
+// --formula (J toggles) and --power (2 to 8, M steps through them) switch to z^power + c from z = 0 (mandelbrot) or
+// from the pixel with c = --julia X Y (julia, which --julia implies). Everything but z^2 + c renders in float at any
+// zoom with a shader generated for the formula, see FractalPrograms, the other modes only apply to z^2 + c.
+// --shader-cache is the directory of the program binary cache (default shader_cache, see ProgramCache), a start with
+// the binaries there skips compiling. --clear-shader-cache empties it first to measure a cold start. The startup time
+// and how many programs came from the cache are printed before the first frame.
+// --shader-directory reads the shader files from DIR (e.g. src/advanced/resources/shaders) instead of the ones built
+// in, to try edits without building again. Edits of mandelbrot.frag and its includes show up while the demo runs (df64,
+// double, distance estimation and float with P off): its programs are built again and swapped in between frames once
+// they link, a broken edit keeps the running ones. The other shaders are read at startup only.
+//
+// All programs start building before the first frame (see ShaderBuildQueue), a driver with
+// GL_KHR_parallel_shader_compile compiles them side by side. Until the programs of a frame are linked the window shows
+// a placeholder (or keeps the last image), the time to the first image is printed when it is shown.
+
 // Function prototypes
-GLuint compileShader(GLenum type, const char* source);
-GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void window_refresh_callback(GLFWwindow* window);
+bool keyDown(GLFWwindow* window, int key);
+bool isNavigating(GLFWwindow* window);
 
 // Window dimensions
 const int width = 800;
 const int height = 800;
 
-// Vertex Shader source code
-const char* vertexShaderSource = R"(
-    #version 330 core
-    layout(location = 0) in vec2 aPos;
-    void main() {
-        gl_Position = vec4(aPos, 0.0, 1.0);
+// Everything that decides whether the next frame looks different. The callbacks and the zoom keys set dirty, the main
+// loop only renders a frame if it is set (or the view was panned) and sleeps in glfwWaitEvents otherwise.
+struct FrameState {
+    int width = ::width;
+    int height = ::height;
+    int maxIterations = 10000;
+    bool progressive = true;                               // P toggles
+    bool compute = false;                                  // G toggles
+    bool approximation = true;                             // B toggles
+    bool distanceEstimation = false;                       // E toggles
+    int supersamples = 4;
+    float supersampleThreshold = 2.0f;
+    Precision extendedPrecision = Precision::DoubleFloat;  // D toggles df64 and double
+    bool interiorChecks = true;                            // I toggles (off = brute force)
+    bool recording = false;                                // C toggles
+    int palette = 0;                                       // L cycles
+    float paletteLength = 64.0f;
+    bool autoIterations = false;                           // A toggles
+    FractalFormula formula;                                // J toggles the family, M steps the power
+    bool dirty = true;
+
+    // Whether the progressive renderer draws the frames at this precision
+    bool refines(Precision precision) const {
+        return progressive && !compute && !distanceEstimation && formula.isMandelbrot() &&
+               precision == Precision::Single;
+    }
+};
+
+int main(int argc, char** argv) {
+    auto startupBegin = std::chrono::steady_clock::now();
+    FrameState state;
+    double frameTargetMilliseconds = 100.0;
+    bool borderFill = false;
+    bool headless = false;
+    std::string output = "mandelbrot.ppm";
+    BigFloat centerX(-0.5);
+    BigFloat centerY(0.0);
+    double scale = 0.0;  // 0 = whole set across the width
+    std::string capturePrefix = "capture_";
+    ImageFormat captureFormat = ImageFormat::Png;
+    std::string shaderCacheDirectory = "shader_cache";
+    bool clearShaderCache = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--size" && i + 2 < argc) {
+            state.width = std::stoi(argv[++i]);
+            state.height = std::stoi(argv[++i]);
+        } else if (arg == "--output" && hasValue) {
+            output = argv[++i];
+        } else if (arg == "--center" && i + 2 < argc) {
+            if (!BigFloat::parse(argv[i + 1], centerX) || !BigFloat::parse(argv[i + 2], centerY)) {
+                std::cerr << "Invalid center: " << argv[i + 1] << ' ' << argv[i + 2] << '\n';
+                return -1;
+            }
+            i += 2;
+        } else if (arg == "--scale" && hasValue) {
+            scale = std::stod(argv[++i]);
+        } else if (arg == "--iterations" && hasValue) {
+            state.maxIterations = std::stoi(argv[++i]);
+        } else if (arg == "--no-progressive") {
+            state.progressive = false;
+        } else if (arg == "--compute") {
+            state.compute = true;
+        } else if (arg == "--border-fill") {
+            borderFill = true;
+        } else if (arg == "--no-bla") {
+            state.approximation = false;
+        } else if (arg == "--distance") {
+            state.distanceEstimation = true;
+        } else if (arg == "--supersample" && hasValue) {
+            state.supersamples = std::stoi(argv[++i]);
+            if (state.supersamples < 1 || state.supersamples > maxSupersamples) {
+                std::cerr << "The supersampling has to be between 1 and " << maxSupersamples << '\n';
+                return -1;
+            }
+        } else if (arg == "--supersample-threshold" && hasValue) {
+            state.supersampleThreshold = std::stof(argv[++i]);
+        } else if (arg == "--precision" && hasValue) {
+            std::string name = argv[++i];
+            state.extendedPrecision = name == "double" ? Precision::Double : Precision::DoubleFloat;
+        } else if (arg == "--brute-force") {
+            state.interiorChecks = false;
+        } else if (arg == "--capture" && hasValue) {
+            capturePrefix = argv[++i];
+            state.recording = true;
+        } else if (arg == "--capture-format" && hasValue) {
+            if (!parseImageFormat(argv[++i], captureFormat)) {
+                std::cerr << "Unknown image format: " << argv[i] << '\n';
+                return -1;
+            }
+        } else if (arg == "--palette" && hasValue) {
+            state.palette = findPalette(argv[++i]);
+            if (state.palette < 0) {
+                std::cerr << "Unknown palette: " << argv[i] << '\n';
+                return -1;
+            }
+        } else if (arg == "--palette-length" && hasValue) {
+            state.paletteLength = std::stof(argv[++i]);
+        } else if (arg == "--auto-iterations") {
+            state.autoIterations = true;
+        } else if (arg == "--frame-target" && hasValue) {
+            frameTargetMilliseconds = std::stod(argv[++i]);
+        } else if (arg == "--formula" && hasValue) {
+            if (!parseFractalFamily(argv[++i], state.formula.family)) {
+                std::cerr << "Unknown formula: " << argv[i] << '\n';
+                return -1;
+            }
+        } else if (arg == "--power" && hasValue) {
+            state.formula.power = std::stoi(argv[++i]);
+            if (state.formula.power < minFractalPower || state.formula.power > maxFractalPower) {
+                std::cerr << "The power has to be between " << minFractalPower << " and " << maxFractalPower << '\n';
+                return -1;
+            }
+        } else if (arg == "--julia" && i + 2 < argc) {
+            state.formula.family = FractalFamily::Julia;
+            state.formula.juliaX = std::stof(argv[++i]);
+            state.formula.juliaY = std::stof(argv[++i]);
+        } else if (arg == "--shader-directory" && hasValue) {
+            setMandelbrotShaderDirectory(argv[++i]);
+        } else if (arg == "--shader-cache" && hasValue) {
+            shaderCacheDirectory = argv[++i];
+        } else if (arg == "--no-shader-cache") {
+            shaderCacheDirectory.clear();
+        } else if (arg == "--clear-shader-cache") {
+            clearShaderCache = true;
+        } else {
+            std::cerr << "Unknown argument: " << arg << '\n';
+            return -1;
+        }
     }
-)";
 
-// Fragment Shader source code
-const char* fragmentShaderSource = R"(
-    #version 330 core
-    out vec4 FragColor;
-    uniform vec2 u_resolution;
-    uniform vec2 u_center;
-    uniform float u_scale;
-    uniform int u_maxIterations;
+    // OpenGL 4.1 core, the fragment shaders need GLSL 4.00 for precise and double
+    GLFWwindow* window = nullptr;
+    std::unique_ptr<HeadlessContext> headlessContext;
+    if (headless) {
+        // Renders into the context's framebuffer object, which stays bound like a default framebuffer
+        headlessContext = std::make_unique<HeadlessContext>(state.width, state.height, 4, 1);
+        if (!headlessContext->valid()) return -1;
+    } else {
+        // Initialize GLFW
+        if (!glfwInit()) {
+            std::cerr << "Failed to initialize GLFW\n";
+            return -1;
+        }
 
-    void main() {
-        vec2 c = u_center + (gl_FragCoord.xy - u_resolution / 2.0) * u_scale;
-        vec2 z = vec2(0.0);
-        int i;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-        for (i = 0; i < u_maxIterations; i++) {
-            if (length(z) > 2.0) break;
-            z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+        // Create a windowed mode window and its OpenGL context
+        window = glfwCreateWindow(state.width, state.height, "Mandelbrot Set", nullptr, nullptr);
+        if (!window) {
+            std::cerr << "Failed to create GLFW window\n";
+            glfwTerminate();
+            return -1;
         }
 
-        float color = float(i) / float(u_maxIterations);
-        FragColor = vec4(vec3(color), 1.0);
-    }
-)";
+        // Make the window's context current
+        glfwMakeContextCurrent(window);
+
+        // Load OpenGL functions using GLAD
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cerr << "Failed to initialize GLAD\n";
+            return -1;
+        }
 
-int main() {
-    // Initialize GLFW
-    if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW\n";
-        return -1;
+        // Set the viewport
+        glfwGetFramebufferSize(window, &state.width, &state.height);
+        glViewport(0, 0, state.width, state.height);
+        glfwSetWindowUserPointer(window, &state);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetKeyCallback(window, key_callback);
+        glfwSetWindowRefreshCallback(window, window_refresh_callback);
     }
 
-    // Create a windowed mode window and its OpenGL context
-    GLFWwindow* window = glfwCreateWindow(width, height, "Mandelbrot Set", nullptr, nullptr);
-    if (!window) {
-        std::cerr << "Failed to create GLFW window\n";
-        glfwTerminate();
-        return -1;
+    // Linked programs are kept on disk, the next start loads them instead of compiling
+    std::unique_ptr<ProgramCache> programCache;
+    if (!shaderCacheDirectory.empty() && ProgramCache::supported()) {
+        programCache = std::make_unique<ProgramCache>(shaderCacheDirectory);
+        if (clearShaderCache) programCache->clear();
+        ProgramCache::setActive(programCache.get());
     }
 
-    // Make the window's context current
-    glfwMakeContextCurrent(window);
+    // Programs start building where they are created and are checked while the main loop runs
+    auto buildQueue = std::make_unique<ShaderBuildQueue>();
+    ShaderBuildQueue::setActive(buildQueue.get());
 
-    // Load OpenGL functions using GLAD
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD\n";
-        return -1;
-    }
+    // Compile shaders and create a shader program for each precision
+    auto programs = std::make_unique<MandelbrotPrograms>();
 
-    // Set the viewport
-    glViewport(0, 0, width, height);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    // Edits of the shader files of --shader-directory, taken up once the editor is done writing
+    std::unique_ptr<FileWatcher> shaderWatcher;
+    if (!mandelbrotShaderDirectory().empty() && FileWatcher::supported()) {
+        shaderWatcher = std::make_unique<FileWatcher>();
+        if (!watchMandelbrotShaders(*shaderWatcher)) shaderWatcher.reset();
+    }
+    std::chrono::steady_clock::time_point shaderEdit;
+    bool shaderEdited = false;
 
-    // Compile shaders and create a shader program
-    GLuint shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    // Generated shaders of the other formulas, compiled on first use
+    auto fractalPrograms = std::make_unique<FractalPrograms>();
 
-    // Vertex data for a full-screen quad
-    float vertices[] = {
-        -1.0f, -1.0f,  // Bottom-left
-         1.0f, -1.0f,  // Bottom-right
-        -1.0f,  1.0f,  // Top-left
-         1.0f,  1.0f   // Top-right
-    };
+    // The quad all the shaders draw
+    auto quad = std::make_unique<FullScreenQuad>();
 
-    // Index data for two triangles forming the quad
-    unsigned int indices[] = {
-        0, 1, 2,  // First triangle
-        2, 1, 3   // Second triangle
-    };
+    // Deep zoom renderer (reference orbit + perturbation)
+    auto deepZoom = std::make_unique<DeepZoom>();
 
-    // Setup VAO, VBO, and EBO
-    GLuint VAO, VBO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    // Spreads the iterations over several frames, used in single precision
+    auto progressive = std::make_unique<ProgressiveRenderer>();
 
-    glBindVertexArray(VAO);
+    // Tiled compute shader path, needs OpenGL 4.3
+    std::unique_ptr<ComputeMandelbrot> computeRenderer;
+    if (ComputeMandelbrot::supported()) {
+        computeRenderer = std::make_unique<ComputeMandelbrot>();
+        computeRenderer->setBorderFill(borderFill);
+    } else if (state.compute) {
+        std::cerr << "Compute shaders need OpenGL 4.3, using the fragment shader\n";
+        state.compute = false;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // View parameters of all programs live in one uniform buffer, uploaded at most once per frame
+    auto viewBuffer = std::make_unique<UniformBuffer<MandelbrotViewBlock>>(mandelbrotViewBinding);
+
+    // Color lookup tables, each uploaded the first time it is shown
+    auto palettes = std::make_unique<PaletteTextures>();
+    int boundPalette = -1;
+
+    // Iteration limit of the auto mode, measured again whenever the view changed
+    auto iterationBudget = std::make_unique<IterationBudget>();
+    iterationBudget->setTargets(0.01, 0.001, frameTargetMilliseconds);
+    bool budgetStale = true;
+
+    // Created when recording starts for the first time
+    std::unique_ptr<FrameCapture> frameCapture;
+
+    if (scale <= 0.0) scale = 3.5 / state.width;
+    scale = std::max(scale, minimumDeepZoomScale);
+    std::pair<BigFloat, BigFloat> center = {centerX, centerY};
+    std::pair<double, double> pendingPan = {0.0, 0.0};  // in pixels, less than one
+
+    // Frame counters: skipped frames are wake-ups that didn't change the picture
+    std::size_t renderedFrames = 0;
+    std::size_t skippedFrames = 0;
+    double idleSeconds = 0.0;
+    Precision shownPrecision = Precision::Single;
+
+    // Time to first frame: placeholders are shown until the programs of the first image are linked
+    std::size_t placeholderFrames = 0;
+    double firstPlaceholderMilliseconds = 0.0;
+    bool imageShown = false;
+
+    // View uniforms of the current state
+    auto currentView = [&]() {
+        MandelbrotViewBlock view{};
+        view.resolution[0] = state.width;
+        view.resolution[1] = state.height;
+        view.setCenter(center.first.toDouble(), center.second.toDouble());
+        view.scale = static_cast<float>(scale);
+        view.maxIterations = state.maxIterations;
+        view.interiorChecks = state.interiorChecks;
+        view.paletteLength = state.paletteLength;
+        view.supersamples = state.supersamples;
+        view.supersampleThreshold = state.supersampleThreshold;
+        return view;
+    };
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    // Whether the programs the frame at this precision draws with are linked
+    auto frameProgramsReady = [&](Precision precision) {
+        if (!state.formula.isMandelbrot()) return fractalPrograms->ready(state.formula);
+        if (precision == Precision::Perturbation) return deepZoom->ready();
+        if (state.distanceEstimation) return shaderProgramReady(programs->program(precision, true));
+        if (state.compute && precision == Precision::Single) return computeRenderer->ready();
+        if (state.progressive && precision == Precision::Single) return progressive->ready();
+        return shaderProgramReady(programs->program(precision));
+    };
 
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    // Whether one of them is done and has errors, the frame can't be drawn at all
+    auto frameProgramsFailed = [&](Precision precision) {
+        if (!state.formula.isMandelbrot()) return fractalPrograms->failed(state.formula);
+        if (precision == Precision::Perturbation) return deepZoom->failed();
+        if (state.distanceEstimation) return programs->failed(precision, true);
+        if (state.compute && precision == Precision::Single) return computeRenderer->failed();
+        if (state.progressive && precision == Precision::Single) return progressive->failed();
+        return programs->failed(precision);
+    };
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // Compiles one formula a J or M press away from the current one if it isn't cached yet, so the press doesn't wait
+    // for the compiler. Called while idle, one program at a time.
+    auto warmFormula = [&]() {
+        FractalFormula other = state.formula;
+        other.family = other.family == FractalFamily::Julia ? FractalFamily::Mandelbrot : FractalFamily::Julia;
+        FractalFormula next = state.formula;
+        next.power = next.power == maxFractalPower ? minFractalPower : next.power + 1;
+        for (const FractalFormula& formula : {other, next}) {
+            if (!formula.isMandelbrot() && fractalPrograms->prepare(formula)) return true;
+        }
+        return false;
+    };
 
-    float scale = 3.5f / width;
-    std::pair<float, float> center = {-0.5f, 0.0f};
+    // Startup up to the main loop: context, programs (started or from the cache) and buffers
+    std::cout << "Startup: "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count()
+              << " ms";
+    if (programCache) {
+        std::cout << ", programs from the cache: " << programCache->stats().hits << " ("
+                  << programCache->stats().hitMilliseconds << " ms)";
+    }
+    std::cout << ", programs building: " << buildQueue->stats().maxInFlight
+              << (buildQueue->parallel() ? " (parallel)" : " (one per frame)") << '\n';
+
+    // Main loop, left early if a program the frame needs failed to build
+    bool failed = false;
+    while (!window || !glfwWindowShouldClose(window)) {
+        // Programs the driver finished since the last frame get checked and set up
+        buildQueue->poll();
+
+        // Editors write a file in several steps, the programs are built again once it has been quiet for 50 ms
+        if (shaderWatcher) {
+            const auto now = std::chrono::steady_clock::now();
+            if (!shaderWatcher->wait(0).empty()) {
+                shaderEdit = now;
+                shaderEdited = true;
+            } else if (shaderEdited && now - shaderEdit >= std::chrono::milliseconds(50)) {
+                programs->reload();
+                shaderEdited = false;
+            }
+            if (programs->update()) state.dirty = true;
+        }
 
-    // Main loop
-    while (!glfwWindowShouldClose(window)) {
-        // Input handling
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-            glfwSetWindowShouldClose(window, true);
+        // Input handling (Escape and the iteration budget are handled in key_callback)
 
         // Zoom in (W key)
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-            scale *= 0.9f;  // Zoom in
+        if (keyDown(window, GLFW_KEY_W)) {
+            scale = std::max(scale * 0.9, minimumDeepZoomScale);  // Zoom in, as far as the deep zoom goes
+            state.dirty = true;
         }
 
         // Zoom out (S key)
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-            scale /= 0.9f;  // Zoom out
+        if (keyDown(window, GLFW_KEY_S)) {
+            scale /= 0.9;  // Zoom out
+            state.dirty = true;
         }
 
+        // The center has to resolve a fraction of a pixel, otherwise small moves get lost
+        center.first.setPrecision(requiredPrecisionBits(scale));
+        center.second.setPrecision(requiredPrecisionBits(scale));
+
         // Move up (UP arrow key)
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-            center.second += scale * 0.1f;
+        if (keyDown(window, GLFW_KEY_UP)) {
+            pendingPan.second += 0.1;
         }
 
         // Move down (DOWN arrow key)
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-            center.second -= scale * 0.1f;
+        if (keyDown(window, GLFW_KEY_DOWN)) {
+            pendingPan.second -= 0.1;
         }
 
         // Move left (LEFT arrow key)
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-            center.first -= scale * 0.1f;
+        if (keyDown(window, GLFW_KEY_LEFT)) {
+            pendingPan.first -= 0.1;
         }
 
         // Move right (RIGHT arrow key)
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-            center.first += scale * 0.1f;
+        if (keyDown(window, GLFW_KEY_RIGHT)) {
+            pendingPan.first += 0.1;
         }
 
-        // Render
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // Use the shader program
-        glUseProgram(shaderProgram);
+        // Pans are applied in whole pixels, the rest waits for the next frame. That way the previous frame lines up
+        // with the new one and the progressive renderer only has to compute the exposed strip.
+        const int panX = static_cast<int>(pendingPan.first);
+        const int panY = static_cast<int>(pendingPan.second);
+        const bool panned = panX != 0 || panY != 0;
+        if (panned) {
+            center.first += panX * scale;
+            center.second += panY * scale;
+            pendingPan.first -= panX;
+            pendingPan.second -= panY;
+        }
 
-        // Set uniforms
-        glUniform2f(glGetUniformLocation(shaderProgram, "u_resolution"), width, height);
-        glUniform2f(glGetUniformLocation(shaderProgram, "u_center"), center.first, center.second);
-        glUniform1f(glGetUniformLocation(shaderProgram, "u_scale"), scale);
-        glUniform1i(glGetUniformLocation(shaderProgram, "u_maxIterations"), 10000);
+        // The pixel size decides the arithmetic
+        const Precision precision = precisionForScale(scale, state.extendedPrecision);
+        if (precision != shownPrecision) {
+            std::cout << "Precision: " << precisionName(precision) << '\n';
+            shownPrecision = precision;
+        }
 
-        // Draw the full-screen quad using the index buffer
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        // A finished sample pass may move the iteration limit, which needs a new frame
+        if (iterationBudget->poll() && state.autoIterations) {
+            const IterationStatistics& statistics = iterationBudget->statistics();
+            statistics.print(std::cout);
+            if (iterationBudget->budget() != state.maxIterations) {
+                state.maxIterations = iterationBudget->budget();
+                state.dirty = true;
+            }
+            if (window) {
+                std::string title = "Mandelbrot Set - " + std::to_string(state.maxIterations) + " iterations (auto), " +
+                                    std::to_string(statistics.unresolvedFraction * 100.0) + " % unresolved, " +
+                                    std::to_string(statistics.frameMilliseconds) + " ms";
+                glfwSetWindowTitle(window, title.c_str());
+            }
+        }
 
-        // Swap buffers
-        glfwSwapBuffers(window);
+        // A progressive frame keeps refining until all pixels are done
+        bool refining = state.refines(precision) && !progressive->finished();
 
-        // Poll for and process events
-        glfwPollEvents();
-    }
-
-    // Cleanup
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteProgram(shaderProgram);
+        const bool needsFrame = state.dirty || panned || refining;
+        if (needsFrame && frameProgramsFailed(precision)) {
+            std::cerr << "The programs of the frame failed to build, see the errors above\n";
+            failed = true;
+            break;
+        }
+        if (needsFrame && !frameProgramsReady(precision)) {
+            // Still building: the placeholder until there is an image, after that the last image stays. The frame
+            // is drawn once the programs are linked.
+            if (!imageShown) {
+                glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+                glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+                if (window) glfwSwapBuffers(window);
+                if (placeholderFrames++ == 0) {
+                    firstPlaceholderMilliseconds =
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin)
+                            .count();
+                }
+            }
+            state.dirty = true;
+        } else if (needsFrame) {
+            // Render
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            // Update the view uniforms (skipped if nothing changed)
+            viewBuffer->update(currentView());
+
+            // Switching palettes is a texture bind, the programs stay the same
+            if (state.palette != boundPalette) {
+                palettes->bind(state.palette);
+                boundPalette = state.palette;
+            }
+
+            if (!state.formula.isMandelbrot()) {
+                // Specialized program of the formula, cached after its first frame
+                fractalPrograms->use(state.formula);
+                quad->draw();
+            } else if (precision == Precision::Perturbation) {
+                // Use the perturbation program, it sets its own uniforms
+                deepZoom->setApproximation(state.approximation);
+                deepZoom->prepare(center.first, center.second, scale, state.maxIterations, state.width, state.height);
+
+                // Draw the full-screen quad using the index buffer
+                quad->draw();
+            } else if (state.distanceEstimation) {
+                // One full-screen pass, the shader supersamples the pixels near the boundary itself
+                glUseProgram(programs->program(precision, true));
+                quad->draw();
+            } else if (state.compute && precision == Precision::Single) {
+                // Persistent work groups take tiles from an atomic counter, then the image is copied to the screen
+                computeRenderer->render(state.width, state.height);
+                computeRenderer->draw();
+            } else if (state.progressive && precision == Precision::Single) {
+                // Start over if the view changed, reuse what is still on screen after a pan, then add one pass
+                if (state.dirty) {
+                    progressive->reset(state.width, state.height);
+                } else if (panned) {
+                    progressive->shift(*quad, panX, panY);
+                }
+                progressive->renderFrame(*quad, state.maxIterations);
+            } else {
+                // Use the shader program of the precision
+                glUseProgram(programs->program(precision));
+
+                // Draw the full-screen quad using the index buffer
+                quad->draw();
+            }
+
+            // Queue the readback before the swap, the back buffer is undefined afterwards
+            if (state.recording) {
+                if (!frameCapture) frameCapture = std::make_unique<FrameCapture>(capturePrefix, captureFormat);
+                frameCapture->capture(state.width, state.height);
+            }
+
+            // Swap buffers
+            if (window) glfwSwapBuffers(window);
+            budgetStale = budgetStale || state.dirty || panned;
+            state.dirty = false;
+            renderedFrames++;
+            if (!imageShown) {
+                imageShown = true;
+                std::cout << "First frame: "
+                          << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin)
+                                 .count()
+                          << " ms";
+                if (placeholderFrames) {
+                    std::cout << ", " << placeholderFrames << " placeholder frames from "
+                              << firstPlaceholderMilliseconds << " ms";
+                }
+                std::cout << '\n';
+            }
+        } else {
+            skippedFrames++;
+        }
 
-    glfwTerminate();
-    return 0;
-}
+        // Sample pass of the new view with raw counts at a coarser pixel size, read back by a later poll
+        if (state.autoIterations && budgetStale && !iterationBudget->pending() && buildQueue->idle()) {
+            iterationBudget->measure(state.width, state.height, state.maxIterations, [&](int w, int h, int factor) {
+                MandelbrotViewBlock view = currentView();
+                view.resolution[0] = static_cast<float>(w);
+                view.resolution[1] = static_cast<float>(h);
+                view.scale = static_cast<float>(scale * factor);
+                view.paletteLength = -1.0f;
+                viewBuffer->update(view);
+                if (!state.formula.isMandelbrot()) {
+                    fractalPrograms->use(state.formula);
+                } else if (precision == Precision::Perturbation) {
+                    deepZoom->prepare(center.first, center.second, scale * factor, state.maxIterations, w, h);
+                } else {
+                    glUseProgram(programs->program(precision));
+                }
+                quad->draw();
+            });
+            budgetStale = false;
+        }
 
-// Function to compile a shader
-GLuint compileShader(GLenum type, const char* source) {
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
+        // Poll for events while a key is held or the image is still refining, otherwise sleep until something happens
+        refining = state.refines(precisionForScale(scale)) && !progressive->finished();
+        const bool sampling = state.autoIterations && iterationBudget->pending();
+        const bool building = !buildQueue->idle();
+        if (!window) {
+            if (!refining && !sampling && !state.dirty) break;  // headless: the image is complete
+            if (building && buildQueue->parallel()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } else if (isNavigating(window) || refining || sampling || (building && !buildQueue->parallel())) {
+            glfwPollEvents();  // without the extension every poll finishes a program
+        } else if (building) {
+            glfwWaitEventsTimeout(0.002);  // wake up to ask the driver again
+        } else if (warmFormula()) {
+            glfwPollEvents();  // compiled one, look for input before the next
+        } else if (shaderEdited) {
+            glfwWaitEventsTimeout(0.01);  // wake up to reload the shaders
+        } else {
+            auto waitStart = std::chrono::steady_clock::now();
+            if (shaderWatcher) {
+                glfwWaitEventsTimeout(0.1);  // look for shader edits as well
+            } else {
+                glfwWaitEvents();
+            }
+            idleSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+        }
+    }
 
-    int success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::cerr << "Error compiling shader:\n" << infoLog << '\n';
+    if (headlessContext && !failed) {
+        failed = !headlessContext->writePpm(output);
+        if (!failed) std::cout << "Wrote " << output << '\n';
+    }
+    if (frameCapture) {
+        frameCapture->finish();
+        FrameCaptureStats stats = frameCapture->stats();
+        std::cout << "Captured frames: " << stats.written << " of " << stats.captured
+                  << ", readback stalls: " << stats.readbackStalls << ", encoder stalls: " << stats.encoderStalls
+                  << ", encoding: " << (stats.written ? stats.encodeSeconds / stats.written * 1000.0 : 0.0)
+                  << " ms/frame\n";
     }
 
-    return shader;
+    // The setups of unfinished programs refer to the renderers, they have to run before those go away
+    buildQueue->finish();
+
+    const auto streamPrecision = std::cout.precision(17);
+    std::cout << "Center: " << center.first.toString() << ' ' << center.second.toString() << ", scale: " << scale
+              << '\n';
+    std::cout.precision(streamPrecision);
+    std::cout << "Frames rendered: " << renderedFrames << ", skipped: " << skippedFrames << ", idle: " << idleSeconds
+              << " s\n";
+    std::cout << "View buffer uploads: " << viewBuffer->updates() << ", skipped: " << viewBuffer->skippedUpdates()
+              << '\n';
+    std::cout << "Pan frames reprojected: " << progressive->shifts()
+              << ", reused pixels: " << progressive->reusedPixels() << '\n';
+    if (computeRenderer && computeRenderer->renders() && computeRenderer->borderFill()) {
+        std::cout << "Compute renders: " << computeRenderer->renders() << ", tiles filled from their border: "
+                  << computeRenderer->filledTiles() << " of " << computeRenderer->tiles() << '\n';
+    }
+    if (iterationBudget->passes()) {
+        std::cout << "Iteration sample passes: " << iterationBudget->passes()
+                  << ", final limit: " << state.maxIterations << '\n';
+    }
+    const ShaderBuildStats& buildStats = buildQueue->stats();
+    std::cout << "Shader builds: " << buildStats.submitted << " (" << buildStats.fromCache << " from the cache, "
+              << buildStats.failed << " failed), at most " << buildStats.maxInFlight << " at once, "
+              << buildStats.blockingFinishes << " blocking finishes, submitting: " << buildStats.submitMilliseconds
+              << " ms, longest build: " << buildStats.longestBuildMilliseconds << " ms\n";
+    if (programCache) {
+        const ProgramCacheStats& cacheStats = programCache->stats();
+        std::cout << "Program cache: " << cacheStats.hits << " hits, " << cacheStats.misses << " misses, "
+                  << cacheStats.stored << " stored, " << cacheStats.rejected << " rejected\n";
+    }
+    std::cout << "Shader permutations: " << programs->permutations().created() << " created, "
+              << programs->permutations().reused() << " reused";
+    if (programs->permutations().failed()) std::cout << ", " << programs->permutations().failed() << " failed";
+    if (programs->permutations().reloads()) std::cout << ", " << programs->permutations().reloads() << " reloads";
+    std::cout << '\n';
+    if (fractalPrograms->compiled()) {
+        std::cout << "Formula programs compiled: " << fractalPrograms->compiled() << " in "
+                  << fractalPrograms->compileMilliseconds() << " ms, reused: " << fractalPrograms->cacheHits() << '\n';
+    }
+    std::cout << "Deep zoom uniform calls: " << deepZoom->uniforms().issuedCalls()
+              << ", skipped: " << deepZoom->uniforms().skippedCalls() << '\n';
+    if (deepZoom->tablesBuilt()) {
+        std::cout << "BLA tables built: " << deepZoom->tablesBuilt() << ", last: " << deepZoom->table().steps.size()
+                  << " steps in " << deepZoom->table().levels << " levels, " << deepZoom->tableMilliseconds()
+                  << " ms\n";
+    }
+    frameCapture.reset();
+    palettes.reset();
+    computeRenderer.reset();
+    iterationBudget.reset();
+    viewBuffer.reset();
+    programs.reset();
+    shaderWatcher.reset();
+    fractalPrograms.reset();
+    progressive.reset();
+    deepZoom.reset();
+    quad.reset();
+    ShaderBuildQueue::setActive(nullptr);
+    buildQueue.reset();
+    ProgramCache::setActive(nullptr);
+    programCache.reset();
+
+    headlessContext.reset();
+    if (window) glfwTerminate();
+    return failed ? -1 : 0;
 }
 
-// Function to create a shader program
-GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource) {
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+// Callback function to adjust the viewport size when the window size changes
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    glViewport(0, 0, width, height);
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
+    auto* state = static_cast<FrameState*>(glfwGetWindowUserPointer(window));
+    state->width = width;
+    state->height = height;
+    state->dirty = true;
+}
 
-    int success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        std::cerr << "Error linking program:\n" << infoLog << '\n';
+// Callback function for single key presses: Escape closes the window, [ and ] halve/double the iteration budget,
+// P switches progressive rendering on and off, D switches the extended precision between df64 and double, I switches
+// the interior checks on and off, C starts and stops recording, L switches to the next palette, A switches the
+// automatic iteration limit on and off, G switches between the compute and the fragment shader path, B switches the
+// BLA iteration skipping of the perturbation shader on and off, E switches between distance estimation and escape
+// time, J switches between the Mandelbrot and the Julia family, M steps the power of z^power + c from 2 to 8
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (action != GLFW_PRESS) return;
+
+    auto* state = static_cast<FrameState*>(glfwGetWindowUserPointer(window));
+    if (key == GLFW_KEY_ESCAPE) {
+        glfwSetWindowShouldClose(window, true);
+    } else if (key == GLFW_KEY_LEFT_BRACKET && state->maxIterations > 1) {
+        state->maxIterations /= 2;
+        state->dirty = true;
+    } else if (key == GLFW_KEY_RIGHT_BRACKET && state->maxIterations < IterationBudget::maximumIterations) {
+        state->maxIterations = std::min(state->maxIterations * 2, IterationBudget::maximumIterations);
+        state->dirty = true;
+    } else if (key == GLFW_KEY_P) {
+        state->progressive = !state->progressive;
+        state->dirty = true;
+    } else if (key == GLFW_KEY_D) {
+        bool doubleFloat = state->extendedPrecision == Precision::DoubleFloat;
+        state->extendedPrecision = doubleFloat ? Precision::Double : Precision::DoubleFloat;
+        state->dirty = true;
+    } else if (key == GLFW_KEY_I) {
+        state->interiorChecks = !state->interiorChecks;
+        std::cout << "Interior checks: " << (state->interiorChecks ? "on" : "off") << '\n';
+        state->dirty = true;
+    } else if (key == GLFW_KEY_C) {
+        state->recording = !state->recording;
+        std::cout << "Recording: " << (state->recording ? "on" : "off") << '\n';
+    } else if (key == GLFW_KEY_G) {
+        if (ComputeMandelbrot::supported()) {
+            state->compute = !state->compute;
+            std::cout << "Compute shader: " << (state->compute ? "on" : "off") << '\n';
+            state->dirty = true;
+        }
+    } else if (key == GLFW_KEY_B) {
+        state->approximation = !state->approximation;
+        std::cout << "Bilinear approximation: " << (state->approximation ? "on" : "off") << '\n';
+        state->dirty = true;
+    } else if (key == GLFW_KEY_E) {
+        state->distanceEstimation = !state->distanceEstimation;
+        std::cout << "Distance estimation: " << (state->distanceEstimation ? "on" : "off") << '\n';
+        state->dirty = true;
+    } else if (key == GLFW_KEY_J) {
+        bool julia = state->formula.family == FractalFamily::Julia;
+        state->formula.family = julia ? FractalFamily::Mandelbrot : FractalFamily::Julia;
+        std::cout << "Formula: " << fractalFormulaName(state->formula) << '\n';
+        state->dirty = true;
+    } else if (key == GLFW_KEY_M) {
+        state->formula.power = state->formula.power == maxFractalPower ? minFractalPower : state->formula.power + 1;
+        std::cout << "Formula: " << fractalFormulaName(state->formula) << '\n';
+        state->dirty = true;
+    } else if (key == GLFW_KEY_A) {
+        state->autoIterations = !state->autoIterations;
+        std::cout << "Auto iterations: " << (state->autoIterations ? "on" : "off") << '\n';
+        state->dirty = true;
+    } else if (key == GLFW_KEY_L) {
+        state->palette = (state->palette + 1) % static_cast<int>(builtinPalettes().size());
+        std::cout << "Palette: " << builtinPalettes()[state->palette].name << '\n';
+        state->dirty = true;
     }
+}
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return program;
+// Callback function for when the window content got damaged (uncovered, restored, ...)
+void window_refresh_callback(GLFWwindow* window) {
+    static_cast<FrameState*>(glfwGetWindowUserPointer(window))->dirty = true;
 }
 
-// Callback function to adjust the viewport size when the window size changes
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
+// Whether the key is held down, never true without a window (headless)
+bool keyDown(GLFWwindow* window, int key) { return window && glfwGetKey(window, key) == GLFW_PRESS; }
+
+// Whether one of the keys that move the view is held down
+bool isNavigating(GLFWwindow* window) {
+    for (int key : {GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_RIGHT}) {
+        if (keyDown(window, key)) return true;
+    }
+    return false;
 }
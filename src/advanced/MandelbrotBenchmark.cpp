@@ -0,0 +1,398 @@
+#include <glad/glad.h>
+
+#include <ComputeMandelbrot.hpp>
+#include <CpuMandelbrot.hpp>
+#include <DeepZoom.hpp>
+#include <FullScreenQuad.hpp>
+#include <HeadlessContext.hpp>
+#include <MandelbrotPrograms.hpp>
+#include <MandelbrotView.hpp>
+#include <TileScheduler.hpp>
+#include <UniformBuffer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Regression and throughput benchmark of the escape-time renderers. A fixed set of views is rendered at fixed
+// iteration limits on the GPU (headless, every path the demo would take for the view) and on the CPU kernels, and every
+// run reports Miter/s, Mpix/s and the frame time percentiles. The results also go to a JSON file, one entry per view
+// and path, so runs on different commits can be compared.
+//
+// Usage: MandelbrotBenchmark [--size W H] [--frames N] [--view full|seahorse|minibrot] [--no-gpu] [--no-cpu]
+//                            [--simd scalar|sse2|avx2|avx512] [--threads N] [--json results.json]
+//
+// --view can be given more than once, the default is all of them. The views are the whole set, seahorse valley in
+// float and the period 998 mini-brot below seahorse valley in a view 8e-15 wide, which needs perturbation (so it has no
+// CPU run). Their extent is fixed, --size only changes the resolution.
+//
+// Miter/s counts every pixel with its escape count and the interior with the iteration limit, the work of a brute
+// force loop, so it doesn't move when the interior checks get better at skipping. The checksum (FNV-1a of the counts)
+// changes whenever a single count does; the float runs of the GPU and the CPU have the same one.
+
+// A canonical view: the center is hi + lo, the width of the image in the complex plane is span
+struct BenchmarkView {
+    const char* name;
+    double centerX;
+    double centerXLow;
+    double centerY;
+    double centerYLow;
+    double span;
+    int maxIterations;
+};
+
+// One view rendered by one path
+struct BenchmarkResult {
+    std::string view;
+    std::string backend;  // gpu or cpu
+    std::string path;     // float, df64, perturbation, float cs, or the SIMD level
+    int maxIterations = 0;
+    uint64_t totalIterations = 0;
+    uint64_t checksum = 0;
+    std::vector<double> frameSeconds;
+};
+
+// Function prototypes
+const std::vector<BenchmarkView>& benchmarkViews();
+uint64_t countChecksum(const std::vector<uint32_t>& iterations);
+std::vector<uint32_t> readCounts(int width, int height);
+double percentile(std::vector<double> values, double fraction);
+double meanSeconds(const BenchmarkResult& result);
+std::string jsonString(const std::string& text);
+void printResult(const BenchmarkResult& result, int width, int height);
+bool writeJson(const std::string& path,
+               const std::vector<BenchmarkResult>& results,
+               const std::string& renderer,
+               int width,
+               int height,
+               int threads);
+
+int main(int argc, char** argv) {
+    int width = 800;
+    int height = 800;
+    int frames = 10;
+    std::vector<std::string> viewNames;
+    bool gpu = true;
+    bool cpu = true;
+    SimdLevel level = detectSimdLevel();
+    int threads = 0;
+    std::string jsonPath = "mandelbrot_benchmark.json";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && i + 2 < argc) {
+            width = std::stoi(argv[++i]);
+            height = std::stoi(argv[++i]);
+        } else if (arg == "--frames" && hasValue) {
+            frames = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--view" && hasValue) {
+            viewNames.push_back(argv[++i]);
+        } else if (arg == "--no-gpu") {
+            gpu = false;
+        } else if (arg == "--no-cpu") {
+            cpu = false;
+        } else if (arg == "--simd" && hasValue) {
+            if (!parseSimdLevel(argv[++i], level)) {
+                std::cerr << "Unknown instruction set: " << argv[i] << '\n';
+                return -1;
+            }
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else {
+            std::cerr << "Unknown argument: " << arg << '\n';
+            return -1;
+        }
+    }
+
+    std::vector<BenchmarkView> views;
+    for (const BenchmarkView& view : benchmarkViews()) {
+        if (viewNames.empty() || std::find(viewNames.begin(), viewNames.end(), view.name) != viewNames.end()) {
+            views.push_back(view);
+        }
+    }
+    if (views.size() < std::max<std::size_t>(viewNames.size(), 1)) {
+        std::cerr << "Unknown view, the views are full, seahorse and minibrot\n";
+        return -1;
+    }
+    if (level > detectSimdLevel()) {
+        std::cerr << simdLevelName(level) << " is not supported by this CPU\n";
+        return -1;
+    }
+
+    std::vector<BenchmarkResult> results;
+    std::string renderer = "none";
+    std::cout << width << "x" << height << ", " << frames << " frames per run\n";
+    std::cout << std::left << std::setw(10) << "view" << std::setw(18) << "path" << std::right << std::setw(10)
+              << "Miter/s" << std::setw(10) << "Mpix/s" << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms"
+              << std::setw(10) << "p99 ms" << "  checksum\n";
+
+    if (gpu) {
+        // OpenGL 4.1 for the fragment shaders, the compute path only runs where the context has 4.3
+        HeadlessContext context(width, height, 4, 1);
+        if (!context.valid()) {
+            std::cerr << "No OpenGL context, skipping the GPU runs\n";
+        } else {
+            renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+
+            // Raw counts (mandelbrotColor with a negative palette length) need a float target
+            GLuint texture, framebuffer;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, width, height, 0, GL_RG, GL_FLOAT, nullptr);
+            glGenFramebuffers(1, &framebuffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+            glViewport(0, 0, width, height);
+
+            FullScreenQuad quad;
+
+            {
+                MandelbrotPrograms programs;
+                DeepZoom deepZoom;
+                std::unique_ptr<ComputeMandelbrot> computeRenderer;
+                if (ComputeMandelbrot::supported()) computeRenderer = std::make_unique<ComputeMandelbrot>();
+                if (programs.failed(Precision::Single) || programs.failed(Precision::DoubleFloat) ||
+                    deepZoom.failed() || (computeRenderer && computeRenderer->failed())) {
+                    std::cerr << "The Mandelbrot programs failed to build, see the errors above\n";
+                    return -1;
+                }
+                UniformBuffer<MandelbrotViewBlock> viewBuffer(mandelbrotViewBinding);
+
+                for (const BenchmarkView& benchmarkView : views) {
+                    const double scale = benchmarkView.span / width;
+                    MandelbrotViewBlock view{};
+                    view.resolution[0] = width;
+                    view.resolution[1] = height;
+                    view.setCenter(benchmarkView.centerX + benchmarkView.centerXLow,
+                                   benchmarkView.centerY + benchmarkView.centerYLow);
+                    view.scale = static_cast<float>(scale);
+                    view.maxIterations = benchmarkView.maxIterations;
+                    view.interiorChecks = true;
+                    view.paletteLength = -1.0f;
+                    viewBuffer.update(view);
+
+                    BigFloat centerX(benchmarkView.centerX, requiredPrecisionBits(scale));
+                    BigFloat centerY(benchmarkView.centerY, requiredPrecisionBits(scale));
+                    centerX += benchmarkView.centerXLow;
+                    centerY += benchmarkView.centerYLow;
+
+                    // The path the demo takes for the pixel size, plus the compute shader in float
+                    const Precision precision = precisionForScale(scale);
+                    std::vector<std::pair<std::string, std::function<void()>>> paths;
+                    if (precision == Precision::Perturbation) {
+                        paths.emplace_back(precisionName(precision), [&]() {
+                            deepZoom.prepare(centerX, centerY, scale, benchmarkView.maxIterations, width, height);
+                            quad.draw();
+                        });
+                    } else {
+                        paths.emplace_back(precisionName(precision), [&]() {
+                            glUseProgram(programs.program(precision));
+                            quad.draw();
+                        });
+                    }
+                    if (computeRenderer && precision == Precision::Single) {
+                        paths.emplace_back("float cs", [&]() { computeRenderer->render(width, height); });
+                    }
+
+                    for (const auto& path : paths) {
+                        BenchmarkResult result;
+                        result.view = benchmarkView.name;
+                        result.backend = "gpu";
+                        result.path = path.first;
+                        result.maxIterations = benchmarkView.maxIterations;
+
+                        // Warm-up frame (shader compilation, reference orbit), also the one that is checked
+                        path.second();
+                        const bool compute = path.first == "float cs";
+                        if (compute) glBindFramebuffer(GL_FRAMEBUFFER, computeRenderer->framebuffer());
+                        std::vector<uint32_t> iterations = readCounts(width, height);
+                        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+                        for (uint32_t count : iterations) result.totalIterations += count;
+                        result.checksum = countChecksum(iterations);
+
+                        // Wall time of every frame up to glFinish, timer queries aren't reliable on every driver
+                        for (int frame = 0; frame < frames; frame++) {
+                            auto start = std::chrono::steady_clock::now();
+                            path.second();
+                            glFinish();
+                            result.frameSeconds.push_back(
+                                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                        }
+                        printResult(result, width, height);
+                        results.push_back(result);
+                    }
+                }
+            }
+
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteTextures(1, &texture);
+        }
+    }
+
+    TileScheduler scheduler(threads);
+    if (cpu) {
+        for (const BenchmarkView& benchmarkView : views) {
+            const double scale = benchmarkView.span / width;
+            if (precisionForScale(scale) != Precision::Single) continue;  // the kernels iterate in float
+
+            MandelbrotParams params{width,
+                                    height,
+                                    static_cast<float>(benchmarkView.centerX + benchmarkView.centerXLow),
+                                    static_cast<float>(benchmarkView.centerY + benchmarkView.centerYLow),
+                                    static_cast<float>(scale),
+                                    benchmarkView.maxIterations};
+            BenchmarkResult result;
+            result.view = benchmarkView.name;
+            result.backend = "cpu";
+            result.path = simdLevelName(level);
+            result.maxIterations = benchmarkView.maxIterations;
+
+            std::vector<uint32_t> iterations = renderMandelbrotCpu(params, level, scheduler);
+            for (uint32_t count : iterations) result.totalIterations += count;
+            result.checksum = countChecksum(iterations);
+            for (int frame = 0; frame < frames; frame++) {
+                renderMandelbrotCpu(params, level, scheduler);
+                result.frameSeconds.push_back(scheduler.stats().wallSeconds);
+            }
+            printResult(result, width, height);
+            results.push_back(result);
+        }
+    }
+
+    if (!writeJson(jsonPath, results, renderer, width, height, scheduler.threadCount())) {
+        std::cerr << "Failed to write " << jsonPath << '\n';
+        return -1;
+    }
+    std::cout << "Wrote " << jsonPath << '\n';
+    return 0;
+}
+
+const std::vector<BenchmarkView>& benchmarkViews() {
+    static const std::vector<BenchmarkView> views = {
+        {"full", -0.5, 0.0, 0.0, 0.0, 3.5, 1000},
+        {"seahorse", -0.7436438870371589, 0.0, 0.1318259042053123, 0.0, 5e-3, 4000},
+        // Nucleus of the period 998 mini-brot, which is about 6e-16 across
+        {"minibrot", -0.7436438870371589, 1.972920673701857e-17, 0.1318259042053123, 4.123825771614905e-18, 8e-15,
+         10000},
+    };
+    return views;
+}
+
+// FNV-1a over the bytes of the counts
+uint64_t countChecksum(const std::vector<uint32_t>& iterations) {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t count : iterations) {
+        for (int byte = 0; byte < 4; byte++) {
+            hash ^= (count >> (8 * byte)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// Raw counts from the red channel of the bound float framebuffer, bottom row first like the CPU kernels
+std::vector<uint32_t> readCounts(int width, int height) {
+    std::vector<float> pixels(static_cast<std::size_t>(width) * height);
+    glReadPixels(0, 0, width, height, GL_RED, GL_FLOAT, pixels.data());
+
+    std::vector<uint32_t> iterations(pixels.size());
+    for (std::size_t i = 0; i < pixels.size(); i++) iterations[i] = static_cast<uint32_t>(pixels[i]);
+    return iterations;
+}
+
+// Nearest rank, fraction in [0, 1]
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * values.size()));
+    return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+double meanSeconds(const BenchmarkResult& result) {
+    double sum = 0.0;
+    for (double seconds : result.frameSeconds) sum += seconds;
+    return sum / result.frameSeconds.size();
+}
+
+void printResult(const BenchmarkResult& result, int width, int height) {
+    const double seconds = meanSeconds(result);
+    std::cout << std::left << std::setw(10) << result.view << std::setw(18) << (result.backend + " " + result.path)
+              << std::right << std::fixed << std::setprecision(1) << std::setw(10)
+              << result.totalIterations / seconds / 1e6 << std::setprecision(2) << std::setw(10)
+              << static_cast<double>(width) * height / seconds / 1e6 << std::setw(10)
+              << percentile(result.frameSeconds, 0.5) * 1000.0 << std::setw(10)
+              << percentile(result.frameSeconds, 0.9) * 1000.0 << std::setw(10)
+              << percentile(result.frameSeconds, 0.99) * 1000.0 << "  " << std::hex << std::setw(16)
+              << std::setfill('0') << result.checksum << std::dec << std::setfill(' ') << '\n';
+}
+
+// JSON string with quotes and backslashes escaped (the renderer name is the only one from outside)
+std::string jsonString(const std::string& text) {
+    std::string escaped = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) escaped += c;
+    }
+    return escaped + "\"";
+}
+
+bool writeJson(const std::string& path,
+               const std::vector<BenchmarkResult>& results,
+               const std::string& renderer,
+               int width,
+               int height,
+               int threads) {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    char timestamp[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    file << std::setprecision(9);
+    file << "{\n";
+    file << "  \"timestamp\": " << jsonString(timestamp) << ",\n";
+    file << "  \"gpu\": " << jsonString(renderer) << ",\n";
+    file << "  \"cpuThreads\": " << threads << ",\n";
+    file << "  \"width\": " << width << ",\n";
+    file << "  \"height\": " << height << ",\n";
+    file << "  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        const double seconds = meanSeconds(result);
+        const double pixels = static_cast<double>(width) * height;
+        std::ostringstream checksum;
+        checksum << std::hex << std::setw(16) << std::setfill('0') << result.checksum;
+
+        file << (i ? "," : "") << "\n    {\n";
+        file << "      \"view\": " << jsonString(result.view) << ",\n";
+        file << "      \"backend\": " << jsonString(result.backend) << ",\n";
+        file << "      \"path\": " << jsonString(result.path) << ",\n";
+        file << "      \"maxIterations\": " << result.maxIterations << ",\n";
+        file << "      \"totalIterations\": " << result.totalIterations << ",\n";
+        file << "      \"checksum\": " << jsonString(checksum.str()) << ",\n";
+        file << "      \"miterPerSecond\": " << result.totalIterations / seconds / 1e6 << ",\n";
+        file << "      \"pixelsPerSecond\": " << pixels / seconds << ",\n";
+        file << "      \"frameMilliseconds\": {\"mean\": " << seconds * 1000.0
+             << ", \"p50\": " << percentile(result.frameSeconds, 0.5) * 1000.0
+             << ", \"p90\": " << percentile(result.frameSeconds, 0.9) * 1000.0
+             << ", \"p99\": " << percentile(result.frameSeconds, 0.99) * 1000.0
+             << ", \"max\": " << percentile(result.frameSeconds, 1.0) * 1000.0 << "},\n";
+        file << "      \"frames\": " << result.frameSeconds.size() << "\n";
+        file << "    }";
+    }
+    file << "\n  ]\n}\n";
+    return static_cast<bool>(file);
+}
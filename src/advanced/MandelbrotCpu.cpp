@@ -0,0 +1,207 @@
+#include <CpuMandelbrot.hpp>
+#include <Palette.hpp>
+#include <TileScheduler.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Offline Mandelbrot renderer without OpenGL. Renders the same image as the Mandelbrot demo (same uniforms, same
+// iteration counts), so the output can be used as golden reference or for benchmarking on machines without a GPU.
+//
+// Usage: MandelbrotCpu [--size W H] [--center X Y] [--scale S] [--iterations N] [--simd scalar|sse2|avx2|avx512]
+//                      [--threads N] [--output image.pgm] [--counts iterations.raw] [--verify] [--stats] [--scaling]
+//                      [--brute-force] [--palette NAME] [--palette-length N] [--formula mandelbrot|julia] [--power N]
+//                      [--julia X Y]
+//
+// --brute-force turns off the cardioid/bulb test and the cycle detection. --verify checks the kernel against the scalar
+// one and, with the interior checks on, counts the pixels that differ from brute force.
+// --stats prints the tile cost histogram and per thread load, --scaling renders with 1, 2, 4, ... threads and prints
+// the speedup over a single thread. --palette writes a smooth colored PPM (classic, fire, ocean or gray) with the
+// colors of the demo's palette mode, one pass through the palette every --palette-length iterations.
+// --formula and --power (2 to 8) pick z^power + c from z = 0 (mandelbrot) or from the pixel with c = --julia X Y
+// (julia, which --julia implies), see FractalFormula. Those render with a scalar kernel specialized for the formula.
+
+// Function prototypes
+void writeGrayscale(const std::string& path, const MandelbrotParams& params, const std::vector<uint32_t>& iterations);
+void writeColor(const std::string& path, const MandelbrotParams& params, const std::vector<uint8_t>& rgb);
+void writeCounts(const std::string& path, const std::vector<uint32_t>& iterations);
+void printScaling(const MandelbrotParams& params, SimdLevel level, int maxThreads);
+
+int main(int argc, char** argv) {
+    // Defaults of the Mandelbrot demo
+    MandelbrotParams params{800, 800, -0.5f, 0.0f, 3.5f / 800, 10000};
+    SimdLevel level = detectSimdLevel();
+    int threads = 0;
+    std::string output = "mandelbrot.pgm";
+    std::string counts;
+    bool verify = false;
+    bool stats = false;
+    bool scaling = false;
+    int palette = -1;
+    float paletteLength = 64.0f;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && i + 2 < argc) {
+            params.width = std::stoi(argv[++i]);
+            params.height = std::stoi(argv[++i]);
+        } else if (arg == "--center" && i + 2 < argc) {
+            params.centerX = std::stof(argv[++i]);
+            params.centerY = std::stof(argv[++i]);
+        } else if (arg == "--scale" && hasValue) {
+            params.scale = std::stof(argv[++i]);
+        } else if (arg == "--iterations" && hasValue) {
+            params.maxIterations = std::stoi(argv[++i]);
+        } else if (arg == "--simd" && hasValue) {
+            if (!parseSimdLevel(argv[++i], level)) {
+                std::cerr << "Unknown instruction set: " << argv[i] << '\n';
+                return -1;
+            }
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "--output" && hasValue) {
+            output = argv[++i];
+        } else if (arg == "--counts" && hasValue) {
+            counts = argv[++i];
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if (arg == "--stats") {
+            stats = true;
+        } else if (arg == "--scaling") {
+            scaling = true;
+        } else if (arg == "--brute-force") {
+            params.interiorChecks = false;
+        } else if (arg == "--palette" && hasValue) {
+            palette = findPalette(argv[++i]);
+            if (palette < 0) {
+                std::cerr << "Unknown palette: " << argv[i] << '\n';
+                return -1;
+            }
+        } else if (arg == "--palette-length" && hasValue) {
+            paletteLength = std::stof(argv[++i]);
+        } else if (arg == "--formula" && hasValue) {
+            if (!parseFractalFamily(argv[++i], params.formula.family)) {
+                std::cerr << "Unknown formula: " << argv[i] << '\n';
+                return -1;
+            }
+        } else if (arg == "--power" && hasValue) {
+            params.formula.power = std::stoi(argv[++i]);
+            if (params.formula.power < minFractalPower || params.formula.power > maxFractalPower) {
+                std::cerr << "The power has to be between " << minFractalPower << " and " << maxFractalPower << '\n';
+                return -1;
+            }
+        } else if (arg == "--julia" && i + 2 < argc) {
+            params.formula.family = FractalFamily::Julia;
+            params.formula.juliaX = std::stof(argv[++i]);
+            params.formula.juliaY = std::stof(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << '\n';
+            return -1;
+        }
+    }
+
+    if (level > detectSimdLevel()) {
+        std::cerr << simdLevelName(level) << " is not supported by this CPU\n";
+        return -1;
+    }
+
+    TileScheduler scheduler(threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> escapeZ;
+    std::vector<uint32_t> iterations = renderMandelbrotCpu(params, level, scheduler, palette >= 0 ? &escapeZ : nullptr);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t totalIterations = 0;
+    for (uint32_t count : iterations) totalIterations += count;
+    const std::string kernel =
+        params.formula.isMandelbrot() ? simdLevelName(level) : fractalFormulaName(params.formula);
+    std::cout << params.width << "x" << params.height << " using " << kernel << ": " << seconds * 1000.0
+              << " ms, " << totalIterations / seconds / 1e6 << " Miter/s\n";
+    if (stats) scheduler.stats().print(std::cout);
+    if (scaling) printScaling(params, level, scheduler.threadCount());
+
+    if (verify) {
+        // The vectorized kernels have to reproduce the scalar one bit for bit
+        std::vector<uint32_t> reference = renderMandelbrotCpu(params, SimdLevel::Scalar, scheduler);
+        if (reference != iterations) {
+            std::cerr << "Mismatch between " << simdLevelName(level) << " and scalar kernel\n";
+            return -1;
+        }
+        std::cout << "Identical to the scalar kernel\n";
+
+        if (params.interiorChecks) {
+            // Only rounding at the edge of the cardioid may make a difference
+            MandelbrotParams bruteForceParams = params;
+            bruteForceParams.interiorChecks = false;
+            start = std::chrono::steady_clock::now();
+            std::vector<uint32_t> bruteForce = renderMandelbrotCpu(bruteForceParams, level, scheduler);
+            double bruteForceSeconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::size_t differences = 0;
+            for (std::size_t i = 0; i < iterations.size(); i++) differences += iterations[i] != bruteForce[i];
+            std::cout << "Brute force: " << bruteForceSeconds * 1000.0 << " ms, speedup " << bruteForceSeconds / seconds
+                      << "x, " << differences << " pixels differ\n";
+        }
+    }
+
+    if (palette >= 0) {
+        if (output == "mandelbrot.pgm") output = "mandelbrot.ppm";
+        const Palette& colors = builtinPalettes()[palette];
+        writeColor(output, params, colorizeMandelbrot(params, iterations, escapeZ, colors, paletteLength));
+    } else {
+        writeGrayscale(output, params, iterations);
+    }
+    if (!counts.empty()) writeCounts(counts, iterations);
+    return 0;
+}
+
+// Binary PGM with the shader's color: float(i) / float(u_maxIterations), converted to 8 bit like a GL_RGBA8 target
+void writeGrayscale(const std::string& path, const MandelbrotParams& params, const std::vector<uint32_t>& iterations) {
+    std::ofstream file(path, std::ios::binary);
+    file << "P5\n" << params.width << ' ' << params.height << "\n255\n";
+
+    std::vector<unsigned char> row(params.width);
+    for (int y = params.height - 1; y >= 0; y--) {  // PGM starts at the top, gl_FragCoord at the bottom
+        for (int x = 0; x < params.width; x++) {
+            float color = static_cast<float>(iterations[static_cast<std::size_t>(y) * params.width + x]) /
+                          static_cast<float>(params.maxIterations);
+            row[x] = static_cast<unsigned char>(std::lround(color * 255.0f));
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+}
+
+// Binary PPM, rgb is already top row first
+void writeColor(const std::string& path, const MandelbrotParams& params, const std::vector<uint8_t>& rgb) {
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n" << params.width << ' ' << params.height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+}
+
+// Raw little endian uint32 iteration counts, bottom row first (same layout as glReadPixels)
+void writeCounts(const std::string& path, const std::vector<uint32_t>& iterations) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(iterations.data()), iterations.size() * sizeof(uint32_t));
+}
+
+// Wall time for 1, 2, 4, ... maxThreads threads. Close to linear speedup means the stealing keeps everybody busy.
+void printScaling(const MandelbrotParams& params, SimdLevel level, int maxThreads) {
+    double singleThreadSeconds = 0.0;
+    std::cout << "Threads   wall ms  speedup  efficiency\n";
+    for (int threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        TileScheduler scheduler(threads);
+        renderMandelbrotCpu(params, level, scheduler);
+        double seconds = scheduler.stats().wallSeconds;
+        if (threads == 1) singleThreadSeconds = seconds;
+
+        std::cout << std::setw(7) << threads << std::setw(10) << seconds * 1000.0 << std::setw(9)
+                  << singleThreadSeconds / seconds << std::setw(11) << scheduler.stats().efficiency() * 100.0 << " %\n";
+        if (threads == maxThreads) break;
+    }
+}
@@ -0,0 +1,226 @@
+#include <glad/glad.h>
+
+#include <CpuMandelbrot.hpp>
+#include <FullScreenQuad.hpp>
+#include <HeadlessContext.hpp>
+#include <MandelbrotPrograms.hpp>
+#include <MandelbrotView.hpp>
+#include <TileScheduler.hpp>
+#include <TiledTiffWriter.hpp>
+#include <UniformBuffer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Offline renderer for images far larger than any framebuffer or main memory (100k x 100k and up). The image is cut
+// into square tiles that are rendered one after the other, either on the CPU kernels or into a headless framebuffer,
+// and every finished tile goes straight into a tiled BigTIFF. Memory use only depends on the tile size.
+//
+// Usage: MandelbrotPoster [--size W H] [--center X Y] [--scale S] [--iterations N] [--tile N] [--output poster.tif]
+//                         [--gpu] [--simd scalar|sse2|avx2|avx512] [--threads N] [--brute-force] [--restart]
+//
+// An interrupted render continues with the missing tiles when it is started again with the same arguments, --restart
+// starts over. --scale is the pixel size and defaults to the whole set across the width. The CPU kernels iterate in
+// float, --gpu also covers the df64 range.
+
+// Renders the tile with the given center into tileSize * tileSize gray values, top row first
+using TileRenderer = std::function<void(double centerX, double centerY, std::vector<uint8_t>& pixels)>;
+
+// Function prototypes
+uint8_t grayValue(uint32_t iterations, int maxIterations);
+
+int main(int argc, char** argv) {
+    uint32_t width = 16384;
+    uint32_t height = 16384;
+    double centerX = -0.5;
+    double centerY = 0.0;
+    double scale = 0.0;
+    int maxIterations = 1000;
+    uint32_t tileSize = 1024;
+    std::string output = "poster.tif";
+    bool gpu = false;
+    SimdLevel level = detectSimdLevel();
+    int threads = 0;
+    bool interiorChecks = true;
+    bool restart = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && i + 2 < argc) {
+            width = std::stoul(argv[++i]);
+            height = std::stoul(argv[++i]);
+        } else if (arg == "--center" && i + 2 < argc) {
+            centerX = std::stod(argv[++i]);
+            centerY = std::stod(argv[++i]);
+        } else if (arg == "--scale" && hasValue) {
+            scale = std::stod(argv[++i]);
+        } else if (arg == "--iterations" && hasValue) {
+            maxIterations = std::stoi(argv[++i]);
+        } else if (arg == "--tile" && hasValue) {
+            tileSize = std::stoul(argv[++i]);
+        } else if (arg == "--output" && hasValue) {
+            output = argv[++i];
+        } else if (arg == "--gpu") {
+            gpu = true;
+        } else if (arg == "--simd" && hasValue) {
+            if (!parseSimdLevel(argv[++i], level)) {
+                std::cerr << "Unknown instruction set: " << argv[i] << '\n';
+                return -1;
+            }
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "--brute-force") {
+            interiorChecks = false;
+        } else if (arg == "--restart") {
+            restart = true;
+        } else {
+            std::cerr << "Unknown argument: " << arg << '\n';
+            return -1;
+        }
+    }
+    if (scale == 0.0) scale = 3.5 / width;
+    if (tileSize == 0 || tileSize % 16 != 0) {
+        std::cerr << "Tile size " << tileSize << " is not a multiple of 16\n";
+        return -1;
+    }
+
+    if (level > detectSimdLevel()) {
+        std::cerr << simdLevelName(level) << " is not supported by this CPU\n";
+        return -1;
+    }
+    if (scale < (gpu ? extendedPrecisionScale : singlePrecisionScale)) {
+        std::cerr << "Scale " << scale << " needs more precision than " << (gpu ? "df64" : "float (try --gpu)") << '\n';
+        return -1;
+    }
+
+    // Everything that changes pixels, a journal of a different render must not be resumed
+    std::ostringstream description;
+    description << std::setprecision(17) << "Mandelbrot center " << centerX << ' ' << centerY << " scale " << scale
+                << " iterations " << maxIterations << (interiorChecks ? "" : " brute-force");
+    TiledTiffWriter writer(output, width, height, tileSize, description.str(), !restart);
+    if (!writer.valid()) return -1;
+
+    // Only one of the two backends is created
+    std::unique_ptr<TileScheduler> scheduler;
+    std::unique_ptr<HeadlessContext> context;
+    std::unique_ptr<MandelbrotPrograms> programs;
+    std::unique_ptr<UniformBuffer<MandelbrotViewBlock>> viewBuffer;
+    std::unique_ptr<FullScreenQuad> quad;
+    TileRenderer renderTile;
+    const int side = static_cast<int>(tileSize);
+
+    if (gpu) {
+        context = std::make_unique<HeadlessContext>(side, side, 4, 1);
+        if (!context->valid()) return -1;
+
+        quad = std::make_unique<FullScreenQuad>();
+
+        programs = std::make_unique<MandelbrotPrograms>();
+        viewBuffer = std::make_unique<UniformBuffer<MandelbrotViewBlock>>(mandelbrotViewBinding);
+        // A failed program would draw nothing, its tiles must not end up in the journal as done
+        const Precision precision = precisionForScale(scale);
+        if (programs->failed(precision)) {
+            std::cerr << "The " << precisionName(precision) << " program failed to build, see the errors above\n";
+            return -1;
+        }
+        glUseProgram(programs->program(precision));
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        std::cout << "Rendering on " << glGetString(GL_RENDERER) << " in " << precisionName(precision) << '\n';
+
+        renderTile = [&](double tileCenterX, double tileCenterY, std::vector<uint8_t>& pixels) {
+            MandelbrotViewBlock view{};
+            view.resolution[0] = static_cast<float>(side);
+            view.resolution[1] = static_cast<float>(side);
+            view.setCenter(tileCenterX, tileCenterY);
+            view.scale = static_cast<float>(scale);
+            view.maxIterations = maxIterations;
+            view.interiorChecks = interiorChecks;
+            viewBuffer->update(view);
+            quad->draw();
+
+            // The shader's color is the gray value, GL_RGBA8 already rounded it like grayValue does
+            glReadPixels(0, 0, side, side, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+            for (int y = 0; y < side / 2; y++) {  // glReadPixels starts at the bottom
+                std::swap_ranges(pixels.begin() + y * side, pixels.begin() + (y + 1) * side,
+                                 pixels.begin() + (side - 1 - y) * side);
+            }
+        };
+    } else {
+        scheduler = std::make_unique<TileScheduler>(threads);
+        std::cout << "Rendering on " << scheduler->threadCount() << " threads using " << simdLevelName(level) << '\n';
+
+        renderTile = [&](double tileCenterX, double tileCenterY, std::vector<uint8_t>& pixels) {
+            MandelbrotParams params{side,
+                                    side,
+                                    static_cast<float>(tileCenterX),
+                                    static_cast<float>(tileCenterY),
+                                    static_cast<float>(scale),
+                                    maxIterations,
+                                    interiorChecks};
+            std::vector<uint32_t> iterations = renderMandelbrotCpu(params, level, *scheduler);
+            for (int y = 0; y < side; y++) {
+                const uint32_t* row = iterations.data() + static_cast<std::size_t>(side - 1 - y) * side;
+                uint8_t* out = pixels.data() + static_cast<std::size_t>(y) * side;
+                for (int x = 0; x < side; x++) out[x] = grayValue(row[x], maxIterations);
+            }
+        };
+    }
+
+    const std::size_t total = writer.tileCount();
+    const std::size_t resumed = writer.doneTiles();
+    std::cout << width << "x" << height << " in " << total << " tiles of " << tileSize << "x" << tileSize;
+    if (resumed > 0) std::cout << ", " << resumed << " done by a previous run";
+    std::cout << '\n';
+
+    std::vector<uint8_t> pixels(static_cast<std::size_t>(tileSize) * tileSize);
+    auto start = std::chrono::steady_clock::now();
+    auto lastReport = start;
+    std::size_t rendered = 0;
+    for (uint32_t row = 0; row < writer.tilesDown(); row++) {
+        for (uint32_t column = 0; column < writer.tilesAcross(); column++) {
+            if (writer.tileDone(column, row)) continue;
+
+            // Tile centers in double, the float center of a single tile is exact enough for its pixels
+            double tileCenterX = centerX + ((column + 0.5) * tileSize - width / 2.0) * scale;
+            double tileCenterY = centerY + (height / 2.0 - (row + 0.5) * tileSize) * scale;
+            renderTile(tileCenterX, tileCenterY, pixels);
+            if (!writer.writeTile(column, row, pixels.data())) return -1;
+            rendered++;
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastReport > std::chrono::seconds(2)) {
+                writer.flush();
+                lastReport = now;
+                double seconds = std::chrono::duration<double>(now - start).count();
+                double megapixels = static_cast<double>(rendered) * tileSize * tileSize / 1e6;
+                std::size_t done = writer.doneTiles();
+                std::cout << std::fixed << std::setprecision(1) << done << "/" << total << " tiles ("
+                          << 100.0 * done / total << " %), " << megapixels / seconds << " Mpix/s, ETA "
+                          << seconds / rendered * (total - done) << " s" << std::endl;
+            }
+        }
+    }
+
+    bool written = writer.finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megapixels = static_cast<double>(rendered) * tileSize * tileSize / 1e6;
+    std::cout << std::fixed << std::setprecision(1) << "Rendered " << rendered << " tiles in " << seconds << " s, "
+              << (seconds > 0.0 ? megapixels / seconds : 0.0) << " Mpix/s\n";
+
+    return written ? 0 : -1;
+}
+
+// The shader's color: float(i) / float(u_maxIterations), converted to 8 bit like a GL_RGBA8 target
+uint8_t grayValue(uint32_t iterations, int maxIterations) {
+    float color = static_cast<float>(iterations) / static_cast<float>(maxIterations);
+    return static_cast<uint8_t>(std::lround(color * 255.0f));
+}
@@ -0,0 +1,179 @@
+#include <glad/glad.h>
+#include <ComputeMandelbrot.hpp>
+#include <FullScreenQuad.hpp>
+#include <HeadlessContext.hpp>
+#include <MandelbrotPrograms.hpp>
+#include <MandelbrotView.hpp>
+#include <UniformBuffer.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compares the throughput of the float, df64 and double variants of the Mandelbrot shader. Every variant renders the
+// same view into an offscreen float framebuffer. The iteration counts are read back, so the result is in iterations per
+// second and doesn't depend on how fast a precision escapes.
+//
+// Usage: MandelbrotPrecisionBenchmark [--size W H] [--center X Y] [--scale S] [--iterations N] [--frames N]
+//                                     [--brute-force] [--compute] [--border-fill]
+//
+// The default view is at a pixel size where float is already wrong, the "differs" column counts the pixels whose
+// iteration count differs from the double variant. --compute adds the float compute shader (ComputeMandelbrot) as
+// "float cs", it has to match the float fragment shader. --border-fill turns on its approximate border fill, the
+// pixels that costs are in the "Compute vs. fragment float" line. It renders headless, no display is needed.
+
+// Function prototypes
+std::vector<uint32_t> readIterations(int width, int height, int maxIterations);
+
+int main(int argc, char** argv) {
+    int width = 800;
+    int height = 800;
+    double centerX = -0.743643887037151;
+    double centerY = 0.131825904205330;
+    double scale = 1e-9;
+    int maxIterations = 2000;
+    int frames = 10;
+    bool interiorChecks = true;
+    bool compute = false;
+    bool borderFill = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && i + 2 < argc) {
+            width = std::stoi(argv[++i]);
+            height = std::stoi(argv[++i]);
+        } else if (arg == "--center" && i + 2 < argc) {
+            centerX = std::stod(argv[++i]);
+            centerY = std::stod(argv[++i]);
+        } else if (arg == "--scale" && hasValue) {
+            scale = std::stod(argv[++i]);
+        } else if (arg == "--iterations" && hasValue) {
+            maxIterations = std::stoi(argv[++i]);
+        } else if (arg == "--frames" && hasValue) {
+            frames = std::stoi(argv[++i]);
+        } else if (arg == "--brute-force") {
+            interiorChecks = false;
+        } else if (arg == "--compute") {
+            compute = true;
+        } else if (arg == "--border-fill") {
+            borderFill = true;
+        } else {
+            std::cerr << "Unknown argument: " << arg << '\n';
+            return -1;
+        }
+    }
+
+    // OpenGL 4.1 for the fragment shaders, --compute only runs where the context has 4.3
+    HeadlessContext context(width, height, 4, 1);
+    if (!context.valid()) return -1;
+    std::cout << glGetString(GL_RENDERER) << ", " << width << "x" << height << ", scale " << scale << ", "
+              << maxIterations << " iterations\n";
+
+    // Offscreen float target, the color is iterations / maxIterations
+    GLuint texture, framebuffer;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glViewport(0, 0, width, height);
+
+    FullScreenQuad quad;
+
+    {
+        MandelbrotPrograms programs;
+        UniformBuffer<MandelbrotViewBlock> viewBuffer(mandelbrotViewBinding);
+        MandelbrotViewBlock view{};
+        view.resolution[0] = width;
+        view.resolution[1] = height;
+        view.setCenter(centerX, centerY);
+        view.scale = static_cast<float>(scale);
+        view.maxIterations = maxIterations;
+        view.interiorChecks = interiorChecks;
+        viewBuffer.update(view);
+
+        // Double first, it is the reference for the others
+        std::vector<uint32_t> reference;
+        std::vector<uint32_t> singlePrecision;
+        std::cout << std::left << std::setw(8) << "" << std::right << std::setw(12) << "ms/frame" << std::setw(12)
+                  << "Mpix/s" << std::setw(12) << "Miter/s" << std::setw(12) << "differs" << '\n';
+        for (Precision precision : {Precision::Double, Precision::DoubleFloat, Precision::Single}) {
+            if (programs.failed(precision)) {
+                std::cerr << "The " << precisionName(precision) << " program failed to build, see the errors above\n";
+                return -1;
+            }
+            glUseProgram(programs.program(precision));
+
+            // Warm-up frame, also the one that is checked
+            quad.draw();
+            std::vector<uint32_t> iterations = readIterations(width, height, maxIterations);
+            uint64_t totalIterations = 0;
+            for (uint32_t count : iterations) totalIterations += count;
+            if (reference.empty()) reference = iterations;
+            std::size_t differs = 0;
+            for (std::size_t i = 0; i < iterations.size(); i++) differs += iterations[i] != reference[i];
+
+            // Wall time up to glFinish, timer queries aren't reliable on every driver
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; frame++) quad.draw();
+            glFinish();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / frames;
+            std::cout << std::left << std::setw(8) << precisionName(precision) << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(12) << seconds * 1000.0 << std::setw(12)
+                      << width * height / seconds / 1e6 << std::setw(12) << totalIterations / seconds / 1e6
+                      << std::setw(12) << differs << '\n';
+            if (precision == Precision::Single) singlePrecision = iterations;
+        }
+
+        if (compute && !ComputeMandelbrot::supported()) {
+            std::cerr << "Compute shaders need OpenGL 4.3\n";
+        } else if (compute) {
+            // Same measurement, the image is read through its own framebuffer
+            ComputeMandelbrot computeRenderer;
+            computeRenderer.setBorderFill(borderFill);
+            computeRenderer.render(width, height);
+            glBindFramebuffer(GL_FRAMEBUFFER, computeRenderer.framebuffer());
+            std::vector<uint32_t> iterations = readIterations(width, height, maxIterations);
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            uint64_t totalIterations = 0;
+            for (uint32_t count : iterations) totalIterations += count;
+            std::size_t differs = 0;
+            for (std::size_t i = 0; i < iterations.size(); i++) differs += iterations[i] != reference[i];
+            std::size_t mismatches = 0;
+            for (std::size_t i = 0; i < iterations.size(); i++) mismatches += iterations[i] != singlePrecision[i];
+
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; frame++) computeRenderer.render(width, height);
+            glFinish();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / frames;
+            std::cout << std::left << std::setw(8) << "float cs" << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(12) << seconds * 1000.0 << std::setw(12) << width * height / seconds / 1e6
+                      << std::setw(12) << totalIterations / seconds / 1e6 << std::setw(12) << differs << '\n';
+            std::cout << "Compute vs. fragment float: " << mismatches << " pixels differ, "
+                      << computeRenderer.filledTiles() << " of " << computeRenderer.tiles()
+                      << " tiles filled from their border\n";
+        }
+    }
+
+    // Cleanup
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &texture);
+    return 0;
+}
+
+// Iteration counts of the bound framebuffer (red channel = iterations / maxIterations)
+std::vector<uint32_t> readIterations(int width, int height, int maxIterations) {
+    std::vector<float> pixels(static_cast<std::size_t>(width) * height);
+    glReadPixels(0, 0, width, height, GL_RED, GL_FLOAT, pixels.data());
+
+    std::vector<uint32_t> iterations(pixels.size());
+    for (std::size_t i = 0; i < pixels.size(); i++) {
+        iterations[i] = static_cast<uint32_t>(std::lround(pixels[i] * maxIterations));
+    }
+    return iterations;
+}
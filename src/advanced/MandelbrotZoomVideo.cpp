@@ -0,0 +1,175 @@
+#include <glad/glad.h>
+
+#include <DeepZoom.hpp>
+#include <FrameCapture.hpp>
+#include <FullScreenQuad.hpp>
+#include <HeadlessContext.hpp>
+#include <KeyframeZoom.hpp>
+#include <MandelbrotPrograms.hpp>
+#include <MandelbrotView.hpp>
+#include <UniformBuffer.hpp>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Renders a zoom animation headless and reports the frame rate. The zoom is exponential in time: every second goes
+// equally deep. By default the frames are resampled from keyframes (see KeyframeZoom), --direct renders every frame
+// with the Mandelbrot shader instead, --compare runs both and prints the speedup.
+//
+// Usage: MandelbrotZoomVideo [--size W H] [--center X Y] [--end-scale S] [--iterations N] [--duration SECONDS]
+//                            [--fps N] [--oversample N] [--direct] [--compare] [--capture prefix]
+//                            [--capture-format png|qoi|raw] [--no-bla]
+//
+// The path starts with the whole set across the width and ends at the pixel size --end-scale. --capture writes the
+// frames (of the keyframe run) to prefix000000.png, ... --no-bla turns off the iteration skipping of the perturbation
+// shader (see DeepZoom).
+
+int main(int argc, char** argv) {
+    int width = 640;
+    int height = 360;
+    BigFloat centerX;
+    BigFloat centerY;
+    BigFloat::parse("-0.743643887037158704752191506114774", centerX);
+    BigFloat::parse("0.131825904205311970493132056385139", centerY);
+    double endScale = 1e-11;
+    int maxIterations = 2000;
+    double duration = 60.0;
+    int fps = 60;
+    int oversample = 2;
+    bool keyframes = true;
+    bool direct = false;
+    bool approximation = true;
+    std::string capturePrefix;
+    ImageFormat captureFormat = ImageFormat::Png;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && i + 2 < argc) {
+            width = std::stoi(argv[++i]);
+            height = std::stoi(argv[++i]);
+        } else if (arg == "--center" && i + 2 < argc) {
+            if (!BigFloat::parse(argv[i + 1], centerX) || !BigFloat::parse(argv[i + 2], centerY)) {
+                std::cerr << "Invalid center: " << argv[i + 1] << ' ' << argv[i + 2] << '\n';
+                return -1;
+            }
+            i += 2;
+        } else if (arg == "--end-scale" && hasValue) {
+            endScale = std::stod(argv[++i]);
+        } else if (arg == "--iterations" && hasValue) {
+            maxIterations = std::stoi(argv[++i]);
+        } else if (arg == "--duration" && hasValue) {
+            duration = std::stod(argv[++i]);
+        } else if (arg == "--fps" && hasValue) {
+            fps = std::stoi(argv[++i]);
+        } else if (arg == "--oversample" && hasValue) {
+            oversample = std::stoi(argv[++i]);
+        } else if (arg == "--direct") {
+            keyframes = false;
+            direct = true;
+        } else if (arg == "--compare") {
+            keyframes = true;
+            direct = true;
+        } else if (arg == "--no-bla") {
+            approximation = false;
+        } else if (arg == "--capture" && hasValue) {
+            capturePrefix = argv[++i];
+        } else if (arg == "--capture-format" && hasValue) {
+            if (!parseImageFormat(argv[++i], captureFormat)) {
+                std::cerr << "Unknown image format: " << argv[i] << '\n';
+                return -1;
+            }
+        } else {
+            std::cerr << "Unknown argument: " << arg << '\n';
+            return -1;
+        }
+    }
+    if (oversample < 2) {
+        // A keyframe is shown up to 2x magnified before the next one takes over, less would be blurry
+        std::cerr << "--oversample must be at least 2\n";
+        return -1;
+    }
+
+    HeadlessContext context(width, height, 4, 1);
+    if (!context.valid()) return -1;
+
+    FullScreenQuad quad;
+
+    // Zoom level z: the pixel size of a frame is startScale / 2^z
+    const double startScale = 3.5 / width;
+    const int frameCount = static_cast<int>(std::lround(duration * fps));
+    const double endZoom = std::log2(startScale / endScale);
+    std::cout << glGetString(GL_RENDERER) << ", " << width << "x" << height << ", " << frameCount << " frames, zoom 2^"
+              << endZoom << ", " << maxIterations << " iterations\n";
+
+    double keyframeFps = 0.0;
+    {
+        MandelbrotPrograms programs;
+        DeepZoom deepZoom;
+        if (programs.failed(Precision::Single) || programs.failed(Precision::DoubleFloat) || deepZoom.failed()) {
+            std::cerr << "The Mandelbrot programs failed to build, see the errors above\n";
+            return -1;
+        }
+        deepZoom.setApproximation(approximation);
+        UniformBuffer<MandelbrotViewBlock> viewBuffer(mandelbrotViewBinding);
+
+        // Mandelbrot image with the given pixel size into the bound framebuffer
+        auto renderView = [&](double scale, int viewWidth, int viewHeight) {
+            MandelbrotViewBlock view{};
+            view.resolution[0] = static_cast<float>(viewWidth);
+            view.resolution[1] = static_cast<float>(viewHeight);
+            view.setCenter(centerX.toDouble(), centerY.toDouble());
+            view.scale = static_cast<float>(scale);
+            view.maxIterations = maxIterations;
+            view.interiorChecks = true;
+            viewBuffer.update(view);
+
+            Precision precision = precisionForScale(scale);
+            if (precision == Precision::Perturbation) {
+                deepZoom.prepare(centerX, centerY, scale, maxIterations, viewWidth, viewHeight);
+            } else {
+                glUseProgram(programs.program(precision));
+            }
+            quad.draw();
+        };
+        auto zoomAt = [&](int frame) { return frameCount > 1 ? endZoom * frame / (frameCount - 1) : 0.0; };
+
+        if (keyframes) {
+            // Keyframe k has the pixel size of zoom level k, divided by the oversampling
+            KeyframeZoom zoom(width, height, oversample, [&](int keyframe, int w, int h) {
+                renderView(startScale / std::exp2(keyframe) / oversample, w, h);
+            });
+            std::unique_ptr<FrameCapture> capture;
+            if (!capturePrefix.empty()) capture = std::make_unique<FrameCapture>(capturePrefix, captureFormat);
+
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frameCount; frame++) {
+                zoom.drawFrame(quad, zoomAt(frame));
+                if (capture) capture->capture(width, height);
+            }
+            if (capture) capture->finish();
+            glFinish();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            keyframeFps = frameCount / seconds;
+            std::cout << "Keyframes: " << zoom.renderedKeyframes() << " of " << zoom.keyframeWidth() << "x"
+                      << zoom.keyframeHeight() << ", " << seconds << " s, " << keyframeFps << " fps\n";
+        }
+
+        if (direct) {
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frameCount; frame++) {
+                renderView(startScale / std::exp2(zoomAt(frame)), width, height);
+            }
+            glFinish();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "Direct: " << seconds << " s, " << frameCount / seconds << " fps\n";
+            if (keyframes) std::cout << "Speedup: " << keyframeFps * seconds / frameCount << "x\n";
+        }
+    }
+
+    // Cleanup
+    return 0;
+}
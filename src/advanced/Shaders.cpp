@@ -1,61 +1,81 @@
 #pragma once
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <HeadlessContext.hpp>
+#include <Shader.hpp>
+#include <ShaderReloader.hpp>
+#include <iostream>
+#include <memory>
 #include <thread>
 
-// Shaders
-const char *vertexShaderSrc =
-    "#version 330 core\n"
-    "layout (location = 0) in vec3 aPos;\n"
-    "layout (location = 1) in vec3 aColor;\n"
-
-    "out vec3 color;\n"
-    "uniform float scale;\n"
-
-    "void main()\n"
-    "{\n"
-    "   gl_Position = vec4(aPos.x * scale, aPos.y * scale, aPos.z * scale, 1);\n"
-    "   color = aColor;\n"
-    "}\n\0";
-
-const char *fragmentShaderSrc =
-    "#version 330 core\n"
-    "out vec4 FragColor;\n"
-
-    "in vec3 color;\n"
-
-    "void main()\n"
-    "{\n"
-    "  FragColor = vec4(color, 1.0f);"
-    "}\n\0";
-
-int main() {
-    glfwInit();
-
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow *window(glfwCreateWindow(500, 500, "Triangle", nullptr, nullptr));
-    glfwMakeContextCurrent(window);
-    gladLoadGL();
-
-    // Load vertex Shader
-    GLuint vertexShader(glCreateShader(GL_VERTEX_SHADER));
-    glShaderSource(vertexShader, 1, &vertexShaderSrc, nullptr);
-    glCompileShader(vertexShader);
-    // Load fragment Shader
-    GLuint fragmentShader(glCreateShader(GL_FRAGMENT_SHADER));
-    glShaderSource(fragmentShader, 1, &fragmentShaderSrc, nullptr);
-    glCompileShader(fragmentShader);
-    // Create ShaderProgram and link our own shaders
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    // Delete Shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+// pyramidVert and pyramidFrag, the shader files as they were at build time: validated, and with SHADERS_SPIRV
+// compiled to SPIR-V as well (see cmake/EmbedShaders.cmake)
+#include "PyramidShaders.hpp"
+
+// Shader files, edits are picked up while the window is open (see ShaderReloader). The build points it at the
+// resources/shaders directory of the sources.
+#ifndef SHADER_DIRECTORY
+#define SHADER_DIRECTORY "resources/shaders"
+#endif
+const char *vertexShaderPath = SHADER_DIRECTORY "/pyramid.vert";
+const char *fragmentShaderPath = SHADER_DIRECTORY "/pyramid.frag";
+
+// --headless renders a single frame without a window (EGL) and writes it to --output
+int main(int argc, char **argv) {
+    HeadlessOptions headless;
+    headless.width = 500;
+    headless.height = 500;
+    headless.output = "shaders.ppm";
+    if (!parseHeadlessOptions(argc, argv, headless)) return -1;
+
+    GLFWwindow *window = nullptr;
+    GLFWwindow *reloadWindow = nullptr;  // hidden, its context shares objects with the window's
+    std::unique_ptr<HeadlessContext> headlessContext;
+    if (headless.enabled) {
+        headlessContext = std::make_unique<HeadlessContext>(headless.width, headless.height);
+        if (!headlessContext->valid()) return -1;
+    } else {
+        glfwInit();
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        window = glfwCreateWindow(headless.width, headless.height, "Triangle", nullptr, nullptr);
+        glfwMakeContextCurrent(window);
+    }
+    if (window) gladLoadGL();  // the headless context has loaded GLAD already
+
+    // Start with the embedded shaders, the SPIR-V modules need no compiling at all. The files are read when they
+    // change.
+    GLuint program = 0;
+    // location of the scale uniform. A SPIR-V module has no names, pyramid.vert gives it location 0 there.
+    GLint uniID = -1;
+#ifdef EMBEDDED_SHADERS_SPIRV
+    if (Shader::spirvSupported()) {
+        program = Shader(SpirvStages{{GL_VERTEX_SHADER, pyramidVertSpirv, sizeof(pyramidVertSpirv)},
+                                     {GL_FRAGMENT_SHADER, pyramidFragSpirv, sizeof(pyramidFragSpirv)}})
+                      .release();
+        uniID = 0;
+    }
+#endif
+    if (!program) {
+        program = Shader(reinterpret_cast<const char *>(pyramidVert), reinterpret_cast<const char *>(pyramidFrag))
+                      .release();
+        uniID = glGetUniformLocation(program, "scale");
+    }
+    auto shader = std::make_unique<ShaderReloader>(
+        ShaderFiles{{GL_VERTEX_SHADER, vertexShaderPath}, {GL_FRAGMENT_SHADER, fragmentShaderPath}}, program);
+
+    // Edited shader files are compiled on the hidden window's context by the reloader's thread
+    if (window) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        reloadWindow = glfwCreateWindow(1, 1, "Shader reload", nullptr, window);
+        if (reloadWindow && shader->watch([reloadWindow]() { glfwMakeContextCurrent(reloadWindow); },
+                                          []() { glfwMakeContextCurrent(nullptr); })) {
+            std::cout << "Watching " << vertexShaderPath << " and " << fragmentShaderPath << '\n';
+        }
+    }
 
     GLuint VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);  // vertex array object -> stores multiple VBO's
@@ -113,30 +133,44 @@ int main() {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    // get uniform from the shader program to be able to set its value
-    GLuint uniID = glGetUniformLocation(shaderProgram, "scale");
+    while (!window || !glfwWindowShouldClose(window)) {
+        // An edited shader file was compiled, the new program takes over from this frame on. It is GLSL, with its
+        // own uniform locations.
+        if (shader->update()) {
+            uniID = glGetUniformLocation(shader->program(), "scale");
+            std::cout << "Reloaded the shaders\n";
+        }
 
-    while (!glfwWindowShouldClose(window)) {
         glClear(GL_COLOR_BUFFER_BIT);  // clear colors from previous frame
 
-        glUseProgram(shaderProgram);
+        shader->use();
         glUniform1f(uniID, 1.5); // use uniform to make the triangles scale
 
         glBindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 9, GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
 
+        if (!window) break;  // headless: one frame is all there is
         glfwSwapBuffers(window);
         glfwPollEvents();      
     }
+    bool failed = false;
+    if (headlessContext) {
+        failed = !headlessContext->writePpm(headless.output);
+        if (!failed) std::cout << "Wrote " << headless.output << '\n';
+    }
+
     // Delete the buffers
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
-    glDeleteProgram(shaderProgram);
+    shader.reset();  // stops the reloader's thread, which releases the hidden context
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window) {
+        if (reloadWindow) glfwDestroyWindow(reloadWindow);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 
-    return 0;
+    return failed ? -1 : 0;
 }
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "BigFloat.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+    constexpr double limbBase = 4294967296.0;  // 2^32
+
+    std::size_t limbCount(int precisionBits) {
+        return 1 + static_cast<std::size_t>((std::max(precisionBits, 0) + 31) / 32);
+    }
+}
+
+BigFloat::BigFloat(double value, int precisionBits) : negative_(value < 0.0), limbs_(limbCount(precisionBits), 0) {
+    // Every step is exact: the fraction of a double multiplied by 2^32 is still representable
+    double magnitude = std::fabs(value);
+    for (auto& limb : limbs_) {
+        double whole = std::floor(magnitude);
+        limb = static_cast<uint32_t>(whole);
+        magnitude = (magnitude - whole) * limbBase;
+        if (magnitude == 0.0) break;
+    }
+}
+
+bool BigFloat::parse(const std::string& text, BigFloat& value, int precisionBits) {
+    std::size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '+' || text[i] == '-')) negative = text[i++] == '-';
+
+    // The digits without the point, and how many of them are in front of it
+    std::string digits;
+    long point = -1;
+    for (; i < text.size(); i++) {
+        if (text[i] >= '0' && text[i] <= '9') {
+            digits += text[i];
+        } else if (text[i] == '.' && point < 0) {
+            point = static_cast<long>(digits.size());
+        } else {
+            break;
+        }
+    }
+    if (digits.empty()) return false;
+    if (point < 0) point = static_cast<long>(digits.size());
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        std::size_t start = ++i;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-')) i++;
+        if (i == text.size() || i - start > 6) return false;  // beyond any precision anyway
+        char* end = nullptr;
+        point += std::strtol(text.c_str() + start, &end, 10);
+        i = static_cast<std::size_t>(end - text.c_str());
+    }
+    if (i != text.size()) return false;
+    if (point < 0) {
+        digits.insert(0, static_cast<std::size_t>(-point), '0');
+        point = 0;
+    }
+    if (point > static_cast<long>(digits.size())) digits.append(point - digits.size(), '0');
+
+    uint64_t integer = 0;
+    for (long d = 0; d < point; d++) {
+        integer = integer * 10 + (digits[d] - '0');
+        if (integer > 0xffffffffu) return false;
+    }
+    std::string fraction = digits.substr(point);
+    fraction.erase(fraction.find_last_not_of('0') + 1);
+
+    // log2(10) bits per digit and a limb more, so the value prints back as the same digits. The guard limb below it
+    // holds what the divisions truncate and decides the rounding.
+    const int fractionBits = static_cast<int>(std::ceil(fraction.size() * std::log2(10.0))) + 32;
+    BigFloat result(0.0, std::max(precisionBits, fractionBits));
+    const std::size_t count = result.limbs_.size();
+    result.limbs_.push_back(0);
+
+    // Horner from the last digit: fraction = (digit + fraction) / 10
+    for (auto digit = fraction.rbegin(); digit != fraction.rend(); ++digit) {
+        result.limbs_[0] = static_cast<uint32_t>(*digit - '0');
+        uint64_t remainder = 0;
+        for (auto& limb : result.limbs_) {
+            const uint64_t current = (remainder << 32) | limb;
+            limb = static_cast<uint32_t>(current / 10);
+            remainder = current % 10;
+        }
+    }
+    bool roundUp = result.limbs_.back() >= 0x80000000u;
+    result.limbs_.resize(count);
+    for (std::size_t k = count; k > 1 && roundUp; k--) roundUp = ++result.limbs_[k - 1] == 0;
+    if (integer + roundUp > 0xffffffffu) return false;
+    result.limbs_[0] = static_cast<uint32_t>(integer + roundUp);
+    result.negative_ = negative && !result.isZero();
+    value = result;
+    return true;
+}
+
+std::string BigFloat::toString() const {
+    // Every digit is the integer part of the fraction times 10. Rounded to a digit less than the bits resolve, so a
+    // parsed decimal comes back unchanged.
+    std::vector<uint32_t> fraction(limbs_.begin() + 1, limbs_.end());
+    const int digits = std::max(static_cast<int>(precisionBits() * std::log10(2.0)) - 1, 0);
+    std::string decimals;
+    for (int d = 0; d <= digits; d++) {
+        uint64_t carry = 0;
+        for (std::size_t i = fraction.size(); i > 0; i--) {
+            const uint64_t product = static_cast<uint64_t>(fraction[i - 1]) * 10 + carry;
+            fraction[i - 1] = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+        decimals += static_cast<char>('0' + carry);
+    }
+    bool roundUp = decimals.back() >= '5';
+    decimals.pop_back();
+    for (std::size_t d = decimals.size(); d > 0 && roundUp; d--) {
+        roundUp = decimals[d - 1] == '9';
+        decimals[d - 1] = roundUp ? '0' : decimals[d - 1] + 1;
+    }
+    decimals.erase(decimals.find_last_not_of('0') + 1);
+
+    std::string text = negative_ && !isZero() ? "-" : "";
+    text += std::to_string(static_cast<uint64_t>(limbs_[0]) + roundUp);
+    if (!decimals.empty()) text += "." + decimals;
+    return text;
+}
+
+void BigFloat::setPrecision(int precisionBits) { limbs_.resize(limbCount(precisionBits), 0); }
+
+double BigFloat::toDouble() const {
+    auto first = std::find_if(limbs_.begin(), limbs_.end(), [](uint32_t limb) { return limb != 0; });
+    if (first == limbs_.end()) return 0.0;
+
+    // Three limbs cover the 53 bit mantissa of a double, no matter how far down the first set bit is
+    int index = static_cast<int>(first - limbs_.begin());
+    double result = 0.0;
+    for (int i = index; i < std::min(index + 3, static_cast<int>(limbs_.size())); i++) {
+        result += std::ldexp(static_cast<double>(limbs_[i]), -32 * i);
+    }
+    return negative_ ? -result : result;
+}
+
+bool BigFloat::isZero() const {
+    return std::all_of(limbs_.begin(), limbs_.end(), [](uint32_t limb) { return limb == 0; });
+}
+
+BigFloat BigFloat::operator-() const {
+    BigFloat result(*this);
+    result.negative_ = !negative_;
+    return result;
+}
+
+BigFloat BigFloat::operator+(const BigFloat& other) const {
+    if (negative_ == other.negative_) return addMagnitudes(*this, other, negative_);
+    if (compareMagnitude(*this, other) >= 0) return subtractMagnitudes(*this, other, negative_);
+    return subtractMagnitudes(other, *this, other.negative_);
+}
+
+BigFloat BigFloat::operator-(const BigFloat& other) const { return *this + (-other); }
+
+BigFloat BigFloat::operator*(const BigFloat& other) const {
+    const std::size_t n = std::max(limbs_.size(), other.limbs_.size());
+    auto limbAt = [](const BigFloat& value, std::size_t i) { return i < value.limbs_.size() ? value.limbs_[i] : 0u; };
+
+    // Schoolbook multiplication, keeping one guard limb below the result precision. Every product of limbs i and j
+    // lands at limb i + j (low half) and i + j - 1 (high half); the accumulators can't overflow for sane precisions.
+    std::vector<uint64_t> accumulator(n + 1, 0);
+    for (std::size_t i = 0; i < n; i++) {
+        const uint64_t a = limbAt(*this, i);
+        if (a == 0) continue;
+        for (std::size_t j = 0; i + j <= n && j < n; j++) {
+            const uint64_t product = a * limbAt(other, j);
+            accumulator[i + j] += product & 0xffffffffu;
+            if (i + j > 0) accumulator[i + j - 1] += product >> 32;
+        }
+    }
+    for (std::size_t k = n; k > 0; k--) {
+        accumulator[k - 1] += accumulator[k] >> 32;
+        accumulator[k] &= 0xffffffffu;
+    }
+
+    BigFloat result;
+    result.limbs_.assign(n, 0);
+    for (std::size_t k = 0; k < n; k++) result.limbs_[k] = static_cast<uint32_t>(accumulator[k]);
+    result.negative_ = (negative_ != other.negative_) && !result.isZero();
+    return result;
+}
+
+BigFloat& BigFloat::operator+=(double value) {
+    *this = *this + BigFloat(value, precisionBits());
+    return *this;
+}
+
+BigFloat& BigFloat::operator-=(double value) { return *this += -value; }
+
+int BigFloat::compareMagnitude(const BigFloat& a, const BigFloat& b) {
+    const std::size_t n = std::max(a.limbs_.size(), b.limbs_.size());
+    for (std::size_t i = 0; i < n; i++) {
+        uint32_t x = i < a.limbs_.size() ? a.limbs_[i] : 0;
+        uint32_t y = i < b.limbs_.size() ? b.limbs_[i] : 0;
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return 0;
+}
+
+BigFloat BigFloat::addMagnitudes(const BigFloat& a, const BigFloat& b, bool negative) {
+    const std::size_t n = std::max(a.limbs_.size(), b.limbs_.size());
+    BigFloat result;
+    result.limbs_.assign(n, 0);
+    uint64_t carry = 0;
+    for (std::size_t i = n; i > 0; i--) {
+        uint64_t sum = carry;
+        if (i - 1 < a.limbs_.size()) sum += a.limbs_[i - 1];
+        if (i - 1 < b.limbs_.size()) sum += b.limbs_[i - 1];
+        result.limbs_[i - 1] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    result.negative_ = negative && !result.isZero();
+    return result;
+}
+
+BigFloat BigFloat::subtractMagnitudes(const BigFloat& a, const BigFloat& b, bool negative) {
+    // Requires |a| >= |b|
+    const std::size_t n = std::max(a.limbs_.size(), b.limbs_.size());
+    BigFloat result;
+    result.limbs_.assign(n, 0);
+    int64_t borrow = 0;
+    for (std::size_t i = n; i > 0; i--) {
+        int64_t difference = -borrow;
+        if (i - 1 < a.limbs_.size()) difference += a.limbs_[i - 1];
+        if (i - 1 < b.limbs_.size()) difference -= b.limbs_[i - 1];
+        borrow = difference < 0 ? 1 : 0;
+        result.limbs_[i - 1] = static_cast<uint32_t>(difference + (borrow << 32));
+    }
+    result.negative_ = negative && !result.isZero();
+    return result;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Signed fixed-point number with a 32 bit integer part and an adjustable number of 32 bit fraction limbs.
+// Used for the things a float or double can't hold at deep zoom levels (view center, reference orbit).
+class BigFloat {
+    public:
+        BigFloat(double value = 0.0, int precisionBits = 64);
+
+        // Decimal like "-0.743643887037158704752191506114774" or "1.5e-3". The precision grows beyond precisionBits when
+        // the digits need it, none of them is lost to a double. false (value unchanged) for anything else, or for an
+        // integer part that doesn't fit 32 bits.
+        static bool parse(const std::string& text, BigFloat& value, int precisionBits = 64);
+        // Decimal with as many fraction digits as the precision resolves, trailing zeros dropped
+        std::string toString() const;
+
+        // Number of fraction bits (rounded up to whole limbs)
+        int precisionBits() const { return static_cast<int>(limbs_.size() - 1) * 32; }
+        // Grows (or shrinks) the fraction, keeping the value (truncated when shrinking)
+        void setPrecision(int precisionBits);
+
+        double toDouble() const;
+        bool isZero() const;
+
+        BigFloat operator-() const;
+        BigFloat operator+(const BigFloat& other) const;
+        BigFloat operator-(const BigFloat& other) const;
+        BigFloat operator*(const BigFloat& other) const;
+        BigFloat& operator+=(double value);
+        BigFloat& operator-=(double value);
+
+    private:
+        static int compareMagnitude(const BigFloat& a, const BigFloat& b);
+        static BigFloat addMagnitudes(const BigFloat& a, const BigFloat& b, bool negative);
+        static BigFloat subtractMagnitudes(const BigFloat& a, const BigFloat& b, bool negative);
+
+        bool negative_ = false;
+        std::vector<uint32_t> limbs_;  // limbs_[0] is the integer part, then fraction limbs (most significant first)
+};
@@ -0,0 +1,56 @@
+#include "BilinearApproximation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // x first, then y: A = Ay Ax, B = Ay Bx + By. y only holds if its input Ax delta + Bx dc is inside its radius.
+    BlaStep merge(const BlaStep& x, const BlaStep& y, double maxDeltaC) {
+        BlaStep step;
+        step.ax = y.ax * x.ax - y.ay * x.ay;
+        step.ay = y.ax * x.ay + y.ay * x.ax;
+        step.bx = y.ax * x.bx - y.ay * x.by + y.bx;
+        step.by = y.ax * x.by + y.ay * x.bx + y.by;
+
+        const double ax = std::hypot(x.ax, x.ay);
+        const double left = y.radius - std::hypot(x.bx, x.by) * maxDeltaC;
+        double limit = ax > 0.0 ? left / ax : (left > 0.0 ? std::numeric_limits<double>::infinity() : 0.0);
+        step.radius = std::max(0.0, std::min(x.radius, limit));
+
+        // Long steps around |Z| ~ 2 grow past the double range, their radius is far below any delta anyway
+        if (!std::isfinite(step.ax) || !std::isfinite(step.ay) || !std::isfinite(step.bx) ||
+            !std::isfinite(step.by) || !(step.radius >= 0.0)) {
+            step = BlaStep{0.0, 0.0, 0.0, 0.0, 0.0};
+        }
+        return step;
+    }
+}
+
+BlaTable buildBlaTable(const ReferenceOrbit& orbit, double maxDeltaC, double epsilon) {
+    BlaTable table;
+    table.maxDeltaC = maxDeltaC;
+    table.baseSteps = std::max(0, static_cast<int>(orbit.length()) - 2);
+    if (table.baseSteps == 0) return table;
+
+    // Level 0: delta' = 2 Z delta + dc, the dropped delta^2 is below epsilon |2 Z delta| / 2 for |delta| < epsilon |Z|
+    table.steps.reserve(2 * static_cast<std::size_t>(table.baseSteps));
+    for (int n = 1; n <= table.baseSteps; n++) {
+        const double x = orbit.points[2 * n];
+        const double y = orbit.points[2 * n + 1];
+        table.steps.push_back(BlaStep{2.0 * x, 2.0 * y, 1.0, 0.0, epsilon * std::hypot(x, y)});
+    }
+    table.levels = 1;
+
+    std::size_t previous = 0;  // first step of the level below
+    for (int size = table.baseSteps >> 1; size > 0; size >>= 1) {
+        const std::size_t first = table.steps.size();
+        for (int j = 0; j < size; j++) {
+            BlaStep step = merge(table.steps[previous + 2 * j], table.steps[previous + 2 * j + 1], maxDeltaC);
+            table.steps.push_back(step);
+        }
+        previous = first;
+        table.levels++;
+    }
+    return table;
+}
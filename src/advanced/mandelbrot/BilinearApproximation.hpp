@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "ReferenceOrbit.hpp"
+
+// l perturbation iterations starting at reference iteration n in one step: delta' = A * delta + B * dc. Valid while
+// |delta| < radius, there the delta^2 terms that the linear form drops are below float resolution.
+struct BlaStep {
+    double ax, ay;
+    double bx, by;
+    double radius;
+};
+
+// Bilinear approximation (BLA) table of a reference orbit. Level 0 has one step per reference iteration n = 1 ...
+// length - 2 (A = 2 Z_n, B = 1), level k + 1 merges pairs of level k steps, so step j of level k covers the 2^k
+// iterations from n = 1 + j * 2^k. A pixel takes the highest level that starts at its n and is valid for its delta.
+struct BlaTable {
+    std::vector<BlaStep> steps;  // level 0, then level 1, ...
+    int baseSteps = 0;           // of level 0, level k has baseSteps >> k
+    int levels = 0;
+    double maxDeltaC = 0.0;      // |dc| the radii hold for, at most the distance of a pixel to the reference
+};
+
+// Builds the table, epsilon is the relative size of the dropped terms (float resolution for the shader)
+BlaTable buildBlaTable(const ReferenceOrbit& orbit, double maxDeltaC, double epsilon);
@@ -0,0 +1,111 @@
+#include "ComputeMandelbrot.hpp"
+
+#include <ShaderUtils.hpp>
+#include <algorithm>
+#include <string>
+
+#include "MandelbrotShaders.hpp"
+#include "MandelbrotView.hpp"
+
+bool ComputeMandelbrot::supported() { return GLAD_GL_VERSION_4_3 != 0; }
+
+ComputeMandelbrot::ComputeMandelbrot(int workGroups, int tilesPerGroup)
+    : workGroups_(workGroups), tilesPerGroup_(tilesPerGroup) {
+    std::string source = mandelbrotShaderSource("mandelbrot.comp");
+    program_ = buildComputeProgram(source.c_str(), [this](GLuint program) {
+        glUniformBlockBinding(program, glGetUniformBlockIndex(program, "View"), mandelbrotViewBinding);
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "u_palette"), mandelbrotPaletteUnit);
+        glUseProgram(0);
+        uniforms_ = std::make_unique<UniformBinding>(program);
+        tilesLocation_ = uniforms_->location("u_tiles");
+        tilesPerGroupLocation_ = uniforms_->location("u_tilesPerGroup");
+        borderFillLocation_ = uniforms_->location("u_borderFill");
+    }, "mandelbrot.comp");
+
+    const GLuint zero[2] = {0, 0};
+    glGenBuffers(1, &counters_);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counters_);
+    glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(zero), zero, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+    glGenTextures(1, &texture_);
+    glGenFramebuffers(1, &framebuffer_);
+}
+
+bool ComputeMandelbrot::ready() const { return shaderProgramReady(program_); }
+
+bool ComputeMandelbrot::failed() const { return shaderProgramFailed(program_); }
+
+ComputeMandelbrot::~ComputeMandelbrot() {
+    glDeleteFramebuffers(1, &framebuffer_);
+    glDeleteTextures(1, &texture_);
+    glDeleteBuffers(1, &counters_);
+    glDeleteProgram(program_);
+}
+
+void ComputeMandelbrot::render(int width, int height) {
+    if (width != width_ || height != height_) resize(width, height);
+    const int tilesAcross = (width + tileSize - 1) / tileSize;
+    const int tilesDown = (height + tileSize - 1) / tileSize;
+    const int tiles = tilesAcross * tilesDown;
+
+    // Only the tile counter starts over, the filled tiles add up over all renders
+    const GLuint zero = 0;
+    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counters_);
+    glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(zero), &zero);
+
+    glUseProgram(program_);
+    uniforms_->set(tilesLocation_, tilesAcross, tilesDown);
+    uniforms_->set(tilesPerGroupLocation_, tilesPerGroup_);
+    uniforms_->set(borderFillLocation_, borderFill_ ? 1 : 0);
+    glBindImageTexture(0, texture_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+
+    // Every group of a round takes tilesPerGroup tiles unless the counter runs out, so the rounds cover all tiles.
+    // The counter carries over from one round to the next.
+    const int groups = std::min(workGroups_, tiles);
+    const int rounds = (tiles + groups * tilesPerGroup_ - 1) / (groups * tilesPerGroup_);
+    for (int round = 0; round < rounds; round++) {
+        if (round > 0) glMemoryBarrier(GL_ATOMIC_COUNTER_BARRIER_BIT);
+        glDispatchCompute(static_cast<GLuint>(groups), 1, 1);
+    }
+
+    // The image is read through the framebuffer (blit, glReadPixels) or as a texture afterwards
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+    renders_++;
+    tiles_ += static_cast<std::size_t>(tiles);
+}
+
+void ComputeMandelbrot::draw() const {
+    GLint previousReadFramebuffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+}
+
+std::size_t ComputeMandelbrot::filledTiles() const {
+    GLuint counters[2] = {0, 0};
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counters_);
+    glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(counters), counters);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+    return counters[1];
+}
+
+void ComputeMandelbrot::resize(int width, int height) {
+    width_ = width;
+    height_ = height;
+
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previousFramebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+}
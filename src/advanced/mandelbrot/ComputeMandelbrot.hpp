@@ -0,0 +1,78 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <UniformBinding.hpp>
+#include <cstddef>
+#include <memory>
+
+// Single precision Mandelbrot as a compute shader (OpenGL 4.3) instead of a full-screen quad. The image is split into
+// 16x16 tiles and a fixed number of work groups stays resident (persistent threads): each group takes the next tile
+// from an atomic counter until none are left, so expensive tiles near the set don't leave the rest of the GPU idle.
+//
+// A dispatch is one round of at most tilesPerGroup tiles per group, render issues as many rounds as needed. Short
+// dispatches keep clear of driver watchdogs, and llvmpipe ends any loop after 65535 iterations in total (the
+// iteration loop included), which a group taking every tile would hit.
+//
+// Same View block, math and coloring as the float fragment shader.
+//
+// Border fill (off unless setBorderFill, and only with the interior checks on) is an approximation: a tile computes
+// its border pixels first and fills the tile as interior if none of them escapes. Only the pixel centers of the
+// border are sampled, so a thin escaping filament that crosses the tile between two of them is filled over and the
+// image differs from the fragment shader there.
+class ComputeMandelbrot {
+    public:
+        static constexpr int tileSize = 16;
+
+        // Whether the context has compute shaders
+        static bool supported();
+
+        explicit ComputeMandelbrot(int workGroups = 256, int tilesPerGroup = 4);
+        ~ComputeMandelbrot();
+        ComputeMandelbrot(const ComputeMandelbrot&) = delete;
+        ComputeMandelbrot& operator=(const ComputeMandelbrot&) = delete;
+
+        // The program is built through the active ShaderBuildQueue, render needs it linked
+        bool ready() const;
+        bool failed() const;
+
+        // Renders the view of the View block into the image, resized to width x height if needed
+        void render(int width, int height);
+
+        // Copies the image into the bound draw framebuffer
+        void draw() const;
+
+        // RGBA32F image with the colors (or raw counts, see mandelbrotColor) and a framebuffer to read it
+        GLuint texture() const { return texture_; }
+        GLuint framebuffer() const { return framebuffer_; }
+
+        int workGroups() const { return workGroups_; }
+        int tilesPerGroup() const { return tilesPerGroup_; }
+
+        // Fill tiles whose border samples don't escape, approximate (see above)
+        void setBorderFill(bool enabled) { borderFill_ = enabled; }
+        bool borderFill() const { return borderFill_; }
+
+        std::size_t renders() const { return renders_; }
+        // Tiles of all renders so far that were filled from the border test. Waits for the GPU.
+        std::size_t filledTiles() const;
+        std::size_t tiles() const { return tiles_; }
+
+    private:
+        void resize(int width, int height);
+
+        int workGroups_;
+        int tilesPerGroup_;
+        GLuint program_ = 0;
+        std::unique_ptr<UniformBinding> uniforms_;
+        GLint tilesLocation_ = -1;
+        GLint tilesPerGroupLocation_ = -1;
+        GLint borderFillLocation_ = -1;
+        bool borderFill_ = false;
+        GLuint counters_ = 0;  // next tile, filled tiles
+        GLuint texture_ = 0;
+        GLuint framebuffer_ = 0;
+        int width_ = 0;
+        int height_ = 0;
+        std::size_t renders_ = 0;
+        std::size_t tiles_ = 0;
+};
@@ -0,0 +1,86 @@
+#include "CpuMandelbrot.hpp"
+
+#include "TileScheduler.hpp"
+
+#if defined(MANDELBROT_HAS_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+    // Small enough that even 64 threads get about ten tiles each at 800x800
+    constexpr int tileSize = 32;
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef MANDELBROT_HAS_X86_SIMD
+#ifdef _MSC_VER
+    // CPUID leaf 7 for the feature bits, XGETBV for whether the OS saves the wide registers
+    int info[4];
+    __cpuidex(info, 1, 0);
+    const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    const bool osSavesZmm = osSavesYmm && (_xgetbv(0) & 0xe6) == 0xe6;
+    __cpuidex(info, 7, 0);
+    if (osSavesZmm && (info[1] & (1 << 16))) return SimdLevel::Avx512;
+    if (osSavesYmm && (info[1] & (1 << 5))) return SimdLevel::Avx2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::Avx512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+#endif
+    return SimdLevel::Sse2;  // part of x86-64
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+MandelbrotKernel kernelFor(SimdLevel level) {
+    switch (level) {
+#ifdef MANDELBROT_HAS_X86_SIMD
+        case SimdLevel::Avx512: return iterateTileAvx512;
+        case SimdLevel::Avx2: return iterateTileAvx2;
+        case SimdLevel::Sse2: return iterateTileSse2;
+#endif
+        default: return iterateTileScalar;
+    }
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx512: return "avx512";
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+bool parseSimdLevel(const std::string& name, SimdLevel& level) {
+    for (SimdLevel candidate : {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        if (name == simdLevelName(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint32_t> renderMandelbrotCpu(const MandelbrotParams& params,
+                                          SimdLevel level,
+                                          TileScheduler& scheduler,
+                                          std::vector<float>* escapeZ) {
+    std::vector<uint32_t> iterations(static_cast<std::size_t>(params.width) * params.height);
+    const MandelbrotKernel kernel = params.formula.isMandelbrot() ? kernelFor(level) : formulaKernelFor(params.formula);
+    if (escapeZ) escapeZ->resize(iterations.size() * 2);
+    float* escapeZData = escapeZ ? escapeZ->data() : nullptr;
+
+    scheduler.run(makeTiles(params.width, params.height, tileSize),
+                  [&](const Tile& tile) { kernel(params, tile, iterations.data(), escapeZData); });
+    return iterations;
+}
+
+std::vector<uint32_t> renderMandelbrotCpu(const MandelbrotParams& params,
+                                          SimdLevel level,
+                                          int threadCount,
+                                          std::vector<float>* escapeZ) {
+    TileScheduler scheduler(threadCount);
+    return renderMandelbrotCpu(params, level, scheduler, escapeZ);
+}
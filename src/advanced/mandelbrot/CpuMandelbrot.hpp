@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FractalFormula.hpp"
+
+// Same inputs as the uniforms of the Mandelbrot fragment shader
+struct MandelbrotParams {
+    int width;
+    int height;
+    float centerX;
+    float centerY;
+    float scale;
+    int maxIterations;
+    // Main cardioid / period-2 bulb test and cycle detection. Both only give up on points that never escape, so the
+    // counts match the brute force loop (false) apart from float rounding right at the cardioid's edge.
+    bool interiorChecks = true;
+    // Anything but z^2 + c goes through the scalar formula kernels, see formulaKernelFor
+    FractalFormula formula;
+};
+
+// Rectangle of pixels, (x, y) is the lower left corner like gl_FragCoord
+struct Tile {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+class TileScheduler;
+
+enum class SimdLevel { Scalar, Sse2, Avx2, Avx512 };
+
+// Writes the iteration count of every pixel of the tile into iterations (row-major, stride params.width, bottom row
+// first). All kernels follow the float operations of the shader one by one, so their results are identical. If escapeZ
+// isn't null it gets the last z of every pixel (x, y interleaved, same indexing times two) for smooth coloring.
+//
+// The cycle detection is Brent's: z is saved after 1, 2, 4, 8, ... iterations and every new z is compared with the
+// saved one. An exact match means the float orbit repeats and the pixel ends at maxIterations.
+using MandelbrotKernel = void (*)(const MandelbrotParams& params,
+                                  const Tile& tile,
+                                  uint32_t* iterations,
+                                  float* escapeZ);
+
+void iterateTileScalar(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ);
+#ifdef MANDELBROT_HAS_X86_SIMD
+void iterateTileSse2(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ);
+void iterateTileAvx2(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ);
+void iterateTileAvx512(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ);
+#endif
+
+// Scalar kernel specialized for the family and power of the formula (2 ... maxFractalPower). The interior checks are
+// only the cycle detection there.
+MandelbrotKernel formulaKernelFor(const FractalFormula& formula);
+
+// Best instruction set the CPU (and the build) supports
+SimdLevel detectSimdLevel();
+MandelbrotKernel kernelFor(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
+// Level of a name simdLevelName returns, false for any other name
+bool parseSimdLevel(const std::string& name, SimdLevel& level);
+
+// Renders all pixels with the kernel of the level (or of params.formula if that isn't z^2 + c), the tiles are spread
+// over the scheduler's threads (work stealing). escapeZ is resized and filled if given.
+std::vector<uint32_t> renderMandelbrotCpu(const MandelbrotParams& params,
+                                          SimdLevel level,
+                                          TileScheduler& scheduler,
+                                          std::vector<float>* escapeZ = nullptr);
+// Same with a temporary scheduler of threadCount threads (0 = one per core)
+std::vector<uint32_t> renderMandelbrotCpu(const MandelbrotParams& params,
+                                          SimdLevel level,
+                                          int threadCount = 0,
+                                          std::vector<float>* escapeZ = nullptr);
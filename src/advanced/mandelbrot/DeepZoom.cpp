@@ -0,0 +1,184 @@
+#include "DeepZoom.hpp"
+
+#include <ShaderUtils.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "MandelbrotShaders.hpp"
+#include "MandelbrotView.hpp"
+
+namespace {
+    // The orbit is stored as a 2D texture, a 1D texture would limit it to GL_MAX_TEXTURE_SIZE iterations. The BLA
+    // table uses the same width, two texels per step.
+    constexpr int orbitTextureWidth = 1024;
+    constexpr GLint blaTextureUnit = 2;
+
+    // Dropped terms of a BLA step stay below float resolution
+    const double blaEpsilon = std::ldexp(1.0, -24);
+}
+
+DeepZoom::DeepZoom() {
+    std::string vertexSource = mandelbrotShaderSource("mandelbrot.vert");
+    std::string source = mandelbrotShaderSource("deep_zoom.frag");
+    program_ = buildShaderProgram(vertexSource.c_str(), source.c_str(), [this](GLuint program) {
+        glUniformBlockBinding(program, glGetUniformBlockIndex(program, "View"), mandelbrotViewBinding);
+
+        // Locations are resolved once, after linking
+        uniforms_ = std::make_unique<UniformBinding>(program);
+        scaleMantissaLocation_ = uniforms_->location("u_scaleMantissa");
+        scaleExponentLocation_ = uniforms_->location("u_scaleExponent");
+        referenceOffsetLocation_ = uniforms_->location("u_referenceOffset");
+        orbitLengthLocation_ = uniforms_->location("u_orbitLength");
+        blaStepsLocation_ = uniforms_->location("u_blaSteps");
+        blaLevelsLocation_ = uniforms_->location("u_blaLevels");
+
+        glUseProgram(program);
+        uniforms_->set(uniforms_->location("u_orbit"), 0);
+        uniforms_->set(uniforms_->location("u_bla"), blaTextureUnit);
+        uniforms_->set(uniforms_->location("u_palette"), mandelbrotPaletteUnit);
+        glUseProgram(0);
+    }, "deep_zoom.frag");
+
+    for (GLuint* texture : {&orbitTexture_, &blaTexture_}) {
+        glGenTextures(1, texture);
+        glBindTexture(GL_TEXTURE_2D, *texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+DeepZoom::~DeepZoom() {
+    glDeleteTextures(1, &blaTexture_);
+    glDeleteTextures(1, &orbitTexture_);
+    glDeleteProgram(program_);
+}
+
+bool DeepZoom::ready() const { return shaderProgramReady(program_); }
+
+bool DeepZoom::failed() const { return shaderProgramFailed(program_); }
+
+void DeepZoom::prepare(const BigFloat& centerX,
+                       const BigFloat& centerY,
+                       double scale,
+                       int maxIterations,
+                       int width,
+                       int height) {
+    if (needsNewReference(centerX, centerY, scale, maxIterations, width, height)) {
+        // Reference point in the middle of the screen
+        BigFloat referenceX = centerX;
+        BigFloat referenceY = centerY;
+        referenceX.setPrecision(requiredPrecisionBits(scale));
+        referenceY.setPrecision(requiredPrecisionBits(scale));
+
+        orbit_ = computeReferenceOrbit(referenceX, referenceY, maxIterations);
+        orbitIterations_ = maxIterations;
+        referenceValid_ = true;
+        tableValid_ = false;
+        uploadOrbit();
+    }
+
+    int scaleExponent;
+    double scaleMantissa = std::frexp(scale, &scaleExponent);
+    double offsetX = (centerX - orbit_.centerX).toDouble() / scale;
+    double offsetY = (centerY - orbit_.centerY).toDouble() / scale;
+
+    // Largest |dc| of the view: the corner farthest from the reference. Built with room to pan and zoom out a bit.
+    if (approximation_) {
+        double maxDeltaC = (std::hypot(width, height) / 2.0 + std::hypot(offsetX, offsetY)) * scale;
+        if (!tableValid_ || maxDeltaC > table_.maxDeltaC || maxDeltaC < table_.maxDeltaC / 16.0) {
+            auto start = std::chrono::steady_clock::now();
+            table_ = buildBlaTable(orbit_, 2.0 * maxDeltaC, blaEpsilon);
+            tableUploaded_ = uploadTable();
+            if (!tableUploaded_) {
+                std::cerr << "BLA table of " << table_.steps.size()
+                          << " steps exceeds GL_MAX_TEXTURE_SIZE, iterating every step\n";
+            }
+            tableMilliseconds_ =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            tableValid_ = true;
+            tablesBuilt_++;
+        }
+    }
+
+    glUseProgram(program_);
+    glActiveTexture(GL_TEXTURE0 + blaTextureUnit);
+    glBindTexture(GL_TEXTURE_2D, blaTexture_);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, orbitTexture_);
+
+    // u_resolution and u_maxIterations come from the View block
+    uniforms_->set(scaleMantissaLocation_, static_cast<float>(scaleMantissa));
+    uniforms_->set(scaleExponentLocation_, scaleExponent);
+    uniforms_->set(referenceOffsetLocation_, static_cast<float>(offsetX), static_cast<float>(offsetY));
+    uniforms_->set(orbitLengthLocation_, static_cast<int>(orbit_.length()));
+    uniforms_->set(blaStepsLocation_, table_.baseSteps);
+    uniforms_->set(blaLevelsLocation_, approximation_ && tableUploaded_ ? table_.levels : 0);
+}
+
+bool DeepZoom::needsNewReference(const BigFloat& centerX,
+                                 const BigFloat& centerY,
+                                 double scale,
+                                 int maxIterations,
+                                 int width,
+                                 int height) const {
+    if (!referenceValid_ || maxIterations != orbitIterations_) return true;
+    if (orbit_.centerX.precisionBits() < requiredPrecisionBits(scale)) return true;
+
+    // Rebasing copes with any reference, but one far outside the screen makes the offsets lose precision
+    double offsetX = (centerX - orbit_.centerX).toDouble() / scale;
+    double offsetY = (centerY - orbit_.centerY).toDouble() / scale;
+    return std::max(std::fabs(offsetX), std::fabs(offsetY)) > std::max(width, height);
+}
+
+void DeepZoom::uploadOrbit() {
+    const int length = static_cast<int>(orbit_.length());
+    const int rows = (length + orbitTextureWidth - 1) / orbitTextureWidth;
+
+    std::vector<float> texels(2 * static_cast<std::size_t>(orbitTextureWidth) * rows, 0.0f);
+    std::transform(orbit_.points.begin(), orbit_.points.end(), texels.begin(), [](double value) {
+        return static_cast<float>(value);
+    });
+
+    glBindTexture(GL_TEXTURE_2D, orbitTexture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, orbitTextureWidth, rows, 0, GL_RG, GL_FLOAT, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool DeepZoom::uploadTable() {
+    const int texelCount = 2 * static_cast<int>(table_.steps.size());
+    const int rows = std::max(1, (texelCount + orbitTextureWidth - 1) / orbitTextureWidth);
+
+    // About four texels per orbit iteration, several million iterations go past the height limit
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (rows > maxSize) return false;
+
+    // A and B as float mantissa and exponent (their magnitude goes far past the float range), the radius as log2
+    std::vector<float> texels(4 * static_cast<std::size_t>(orbitTextureWidth) * rows, 0.0f);
+    float* texel = texels.data();
+    for (const BlaStep& step : table_.steps) {
+        int exponentA = 0;
+        int exponentB = 0;
+        std::frexp(std::max(std::fabs(step.ax), std::fabs(step.ay)), &exponentA);
+        std::frexp(std::max(std::fabs(step.bx), std::fabs(step.by)), &exponentB);
+        texel[0] = static_cast<float>(std::ldexp(step.ax, -exponentA));
+        texel[1] = static_cast<float>(std::ldexp(step.ay, -exponentA));
+        texel[2] = static_cast<float>(std::ldexp(step.bx, -exponentB));
+        texel[3] = static_cast<float>(std::ldexp(step.by, -exponentB));
+        texel[4] = static_cast<float>(exponentA);
+        texel[5] = static_cast<float>(exponentB);
+        texel[6] = step.radius > 0.0 ? static_cast<float>(std::log2(step.radius)) : -std::numeric_limits<float>::max();
+        texel += 8;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, blaTexture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, orbitTextureWidth, rows, 0, GL_RGBA, GL_FLOAT, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
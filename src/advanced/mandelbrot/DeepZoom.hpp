@@ -0,0 +1,81 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <UniformBinding.hpp>
+#include <cstddef>
+#include <memory>
+
+#include "BilinearApproximation.hpp"
+#include "ReferenceOrbit.hpp"
+
+// Perturbation renderer for zoom levels below float precision. A reference orbit is computed in high precision on the
+// CPU and uploaded as a texture, the fragment shader iterates the per pixel delta with an extended exponent.
+//
+// The BLA table of the orbit (see BlaTable) goes into a second texture. While a delta is small next to the reference
+// it moves linearly, the shader then skips up to thousands of iterations at once. The radii depend on the largest
+// |dc| of the view, the table is rebuilt when that grows past what it was built for or shrinks a lot. A table too
+// large for GL_MAX_TEXTURE_SIZE isn't used, that orbit is plain perturbation.
+class DeepZoom {
+    public:
+        DeepZoom();
+        ~DeepZoom();
+        DeepZoom(const DeepZoom&) = delete;
+        DeepZoom& operator=(const DeepZoom&) = delete;
+
+        // The program is built through the active ShaderBuildQueue, prepare needs it linked
+        bool ready() const;
+        bool failed() const;
+
+        // Recomputes the reference orbit if needed, binds the program and the orbit and sets the uniforms that
+        // aren't part of the View block. The caller draws the full-screen quad afterwards.
+        void prepare(const BigFloat& centerX,
+                     const BigFloat& centerY,
+                     double scale,
+                     int maxIterations,
+                     int width,
+                     int height);
+
+        // Forces a new reference orbit on the next prepare
+        void invalidate() { referenceValid_ = false; }
+
+        // Iteration skipping with the BLA table, on by default
+        void setApproximation(bool enabled) { approximation_ = enabled; }
+        bool approximation() const { return approximation_; }
+
+        const ReferenceOrbit& orbit() const { return orbit_; }
+        const BlaTable& table() const { return table_; }
+        std::size_t tablesBuilt() const { return tablesBuilt_; }
+        double tableMilliseconds() const { return tableMilliseconds_; }  // building and uploading the last one
+        const UniformBinding& uniforms() const { return *uniforms_; }
+
+    private:
+        bool needsNewReference(const BigFloat& centerX,
+                               const BigFloat& centerY,
+                               double scale,
+                               int maxIterations,
+                               int width,
+                               int height) const;
+        void uploadOrbit();
+        // false if the table is too large for a texture, the shader then iterates every step
+        bool uploadTable();
+
+        GLuint program_ = 0;
+        GLuint orbitTexture_ = 0;
+        GLuint blaTexture_ = 0;
+        std::unique_ptr<UniformBinding> uniforms_;
+        GLint scaleMantissaLocation_ = -1;
+        GLint scaleExponentLocation_ = -1;
+        GLint referenceOffsetLocation_ = -1;
+        GLint orbitLengthLocation_ = -1;
+        GLint blaStepsLocation_ = -1;
+        GLint blaLevelsLocation_ = -1;
+        ReferenceOrbit orbit_;
+        int orbitIterations_ = 0;
+        bool referenceValid_ = false;
+        BlaTable table_;
+        bool tableValid_ = false;
+        bool tableUploaded_ = false;
+        bool approximation_ = true;
+        std::size_t tablesBuilt_ = 0;
+        double tableMilliseconds_ = 0.0;
+};
@@ -0,0 +1,77 @@
+#include "FractalFormula.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+    // Statements of complexPower<power> with r = z^power, the operations in the same order
+    void appendPower(std::string& source, int power) {
+        if (power == 1) {
+            source += "    precise vec2 r = z;\n";
+            return;
+        }
+        appendPower(source, power / 2);
+        source += "    r = vec2(r.x * r.x - r.y * r.y, 2.0 * r.x * r.y);\n";
+        if (power % 2 == 1) source += "    r = vec2(r.x * z.x - r.y * z.y, r.x * z.y + r.y * z.x);\n";
+    }
+
+}
+
+const char* fractalFamilyName(FractalFamily family) {
+    return family == FractalFamily::Julia ? "julia" : "mandelbrot";
+}
+
+bool parseFractalFamily(const std::string& name, FractalFamily& family) {
+    for (FractalFamily candidate : {FractalFamily::Mandelbrot, FractalFamily::Julia}) {
+        if (name == fractalFamilyName(candidate)) {
+            family = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string fractalFormulaName(const FractalFormula& formula) {
+    return fractalFamilyName(formula.family) + std::to_string(formula.power);
+}
+
+float smoothPowerFactor(int power) {
+    return power == 2 ? 1.0f : static_cast<float>(1.0 / std::log2(static_cast<double>(power)));
+}
+
+// |z|^(2 power) of the step after the limit has to stay below 3.4e38
+int smoothEscapeExponent(int power) { return std::min(16, 2 * (19 / power)); }
+
+void fractalStep(int power, float& zx, float& zy, float cx, float cy) {
+    float x = zx;
+    float y = zy;
+    switch (power) {
+        case 3: complexPower<3>(zx, zy, x, y); break;
+        case 4: complexPower<4>(zx, zy, x, y); break;
+        case 5: complexPower<5>(zx, zy, x, y); break;
+        case 6: complexPower<6>(zx, zy, x, y); break;
+        case 7: complexPower<7>(zx, zy, x, y); break;
+        case 8: complexPower<8>(zx, zy, x, y); break;
+        default: complexPower<2>(zx, zy, x, y); break;
+    }
+    zx = x + cx;
+    zy = y + cy;
+}
+
+std::string fractalFormulaSource(const FractalFormula& formula) {
+    // 9 digits make the factor the same float as on the CPU
+    std::ostringstream defines;
+    defines.precision(9);
+    if (formula.family == FractalFamily::Julia) defines << "#define JULIA\n";
+    defines << "#define FRACTAL_STEP(z, c) fractalStep(z, c)\n";
+    defines << "#define FRACTAL_ESCAPE_LIMIT 1e" << smoothEscapeExponent(formula.power) << '\n';
+    defines << "#define FRACTAL_POWER_FACTOR " << std::showpoint << smoothPowerFactor(formula.power) << '\n';
+
+    std::string source = defines.str();
+
+    source += "vec2 fractalStep(vec2 z, vec2 c) {\n";
+    appendPower(source, formula.power);
+    source += "    precise vec2 next = r + c;\n    return next;\n}\n";
+    return source;
+}
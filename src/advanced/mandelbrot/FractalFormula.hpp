@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+
+// Escape-time fractals z -> z^power + c. The Mandelbrot family starts at z_0 = 0 with c the pixel (power 3 and up are
+// the multibrot sets), the Julia family starts at the pixel with c a constant. Both stop at |z| > 2, which holds for
+// every |c| <= 2.
+enum class FractalFamily { Mandelbrot, Julia };
+
+// Powers with a specialized kernel: one template instantiation each on the CPU, one generated shader on the GPU
+constexpr int minFractalPower = 2;
+constexpr int maxFractalPower = 8;
+
+struct FractalFormula {
+    FractalFamily family = FractalFamily::Mandelbrot;
+    int power = 2;
+    // c of the Julia family, a uniform: changing it keeps the kernel
+    float juliaX = -0.8f;
+    float juliaY = 0.156f;
+
+    // z^2 + c from z_0 = 0, what the regular kernels and shaders compute
+    bool isMandelbrot() const { return family == FractalFamily::Mandelbrot && power == 2; }
+};
+
+const char* fractalFamilyName(FractalFamily family);
+// false for unknown names
+bool parseFractalFamily(const std::string& name, FractalFamily& family);
+// "julia3", "mandelbrot2", ...
+std::string fractalFormulaName(const FractalFormula& formula);
+
+// The smooth iteration count is mu = n + 1 - log2(log2 |z_n|) / log2(power), this is 1 / log2(power)
+float smoothPowerFactor(int power);
+// Base 10 exponent of the |z|^2 below which the smooth coloring takes another step: z^power and its |z|^2 stay in the
+// float range. 16 for power 2.
+int smoothEscapeExponent(int power);
+
+// Defines and fractalStep of the formula for the shaders (fractal_formula.glsl), fractal.frag includes it before the
+// coloring
+std::string fractalFormulaSource(const FractalFormula& formula);
+
+// z^Power by squaring from the highest bit of Power down and multiplying by z for every set bit, fully unrolled.
+// fractalFormulaSource generates the same operations for the shaders, so both round alike (with -ffp-contract=off).
+template <int Power>
+inline void complexPower(float zx, float zy, float& x, float& y) {
+    if constexpr (Power == 1) {
+        x = zx;
+        y = zy;
+    } else {
+        complexPower<Power / 2>(zx, zy, x, y);
+        const float squareX = x * x - y * y;
+        const float squareY = 2.0f * x * y;
+        if constexpr (Power % 2 == 1) {
+            x = squareX * zx - squareY * zy;
+            y = squareX * zy + squareY * zx;
+        } else {
+            x = squareX;
+            y = squareY;
+        }
+    }
+}
+
+// z = z^power + c through complexPower, for code outside the inner loop (coloring)
+void fractalStep(int power, float& zx, float& zy, float cx, float cy);
@@ -0,0 +1,61 @@
+#include "FractalPrograms.hpp"
+
+#include <ShaderPreprocessor.hpp>
+#include <ShaderUtils.hpp>
+#include <chrono>
+#include <string>
+
+#include "MandelbrotShaders.hpp"
+#include "MandelbrotView.hpp"
+
+FractalPrograms::FractalPrograms() : vertexShaderSource_(mandelbrotShaderSource("mandelbrot.vert")) {}
+
+FractalPrograms::~FractalPrograms() {
+    for (const auto& entry : variants_) glDeleteProgram(entry.second.program);
+}
+
+void FractalPrograms::use(const FractalFormula& formula) {
+    const std::pair<FractalFamily, int> key{formula.family, formula.power};
+    Variant& current = variant(formula);
+    if (key != used_ && current.used) cacheHits_++;
+    current.used = true;
+    used_ = key;
+    glUseProgram(current.program);
+    current.uniforms->set(current.juliaLocation, formula.juliaX, formula.juliaY);
+}
+
+bool FractalPrograms::ready(const FractalFormula& formula) { return shaderProgramReady(variant(formula).program); }
+
+bool FractalPrograms::failed(const FractalFormula& formula) { return shaderProgramFailed(variant(formula).program); }
+
+bool FractalPrograms::prepare(const FractalFormula& formula) {
+    if (variants_.count({formula.family, formula.power})) return false;
+    variant(formula);
+    return true;
+}
+
+FractalPrograms::Variant& FractalPrograms::variant(const FractalFormula& formula) {
+    Variant& entry = variants_[{formula.family, formula.power}];
+    if (entry.program) return entry;
+
+    auto start = std::chrono::steady_clock::now();
+    ShaderPreprocessor preprocessor;
+    preprocessor.addSource("fractal_formula.glsl", fractalFormulaSource(formula));
+    addMandelbrotShaders(preprocessor);
+    std::string source;
+    if (!preprocessor.process("fractal.frag", {}, source)) source.clear();
+    // The map doesn't move its nodes, entry stays valid until the build queue gets to the setup
+    entry.program = buildShaderProgram(vertexShaderSource_.c_str(), source.c_str(), [&entry](GLuint program) {
+        glUniformBlockBinding(program, glGetUniformBlockIndex(program, "View"), mandelbrotViewBinding);
+
+        GLint previousProgram;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "u_palette"), mandelbrotPaletteUnit);
+        glUseProgram(previousProgram);
+        entry.uniforms = std::make_unique<UniformBinding>(program);
+        entry.juliaLocation = entry.uniforms->location("u_julia");
+    }, "fractal.frag (" + fractalFormulaName(formula) + ")");
+    compileMilliseconds_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return entry;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <UniformBinding.hpp>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "FractalFormula.hpp"
+
+// Full-frame shaders of the formulas other than z^2 + c (those stay with MandelbrotPrograms), single precision. Each
+// family and power gets a program generated for it: z^power is unrolled into the squarings and multiplications of
+// complexPower and the family is a #define, so the inner loop has no pow() and no branch on the formula. The Julia
+// constant is a uniform. Same View block, loop, cycle detection and coloring as the float Mandelbrot shader.
+//
+// A program is compiled the first time its formula is asked for and kept, switching back is a glUseProgram. prepare
+// compiles one ahead of time, the demo warms the formulas one key press away while it idles.
+class FractalPrograms {
+    public:
+        FractalPrograms();
+        ~FractalPrograms();
+        FractalPrograms(const FractalPrograms&) = delete;
+        FractalPrograms& operator=(const FractalPrograms&) = delete;
+
+        // Binds the program of the formula (compiling it first if needed) and sets the Julia constant. The caller
+        // draws the full-screen quad afterwards.
+        void use(const FractalFormula& formula);
+
+        // Compiles the program of the formula unless it is cached, true if it compiled one
+        bool prepare(const FractalFormula& formula);
+        // Whether use can draw the formula yet, starts compiling it if needed (see ShaderBuildQueue)
+        bool ready(const FractalFormula& formula);
+        // Whether the program of the formula is done and has errors
+        bool failed(const FractalFormula& formula);
+
+        std::size_t compiled() const { return variants_.size(); }
+        // Switches back to a formula drawn before, drawing the same one again isn't counted
+        std::size_t cacheHits() const { return cacheHits_; }
+        // All programs so far, with a ShaderBuildQueue only the time to start the builds
+        double compileMilliseconds() const { return compileMilliseconds_; }
+
+    private:
+        struct Variant {
+            GLuint program = 0;
+            std::unique_ptr<UniformBinding> uniforms;
+            GLint juliaLocation = -1;
+            bool used = false;
+        };
+
+        Variant& variant(const FractalFormula& formula);
+
+        std::string vertexShaderSource_;  // mandelbrot.vert
+        std::map<std::pair<FractalFamily, int>, Variant> variants_;  // by family and power
+        std::pair<FractalFamily, int> used_{};                         // key of the previous use
+        std::size_t cacheHits_ = 0;
+        double compileMilliseconds_ = 0.0;
+};
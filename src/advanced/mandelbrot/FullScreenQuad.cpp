@@ -0,0 +1,40 @@
+#include "FullScreenQuad.hpp"
+
+FullScreenQuad::FullScreenQuad() {
+    const float vertices[] = {
+        -1.0f, -1.0f,  // Bottom-left
+         1.0f, -1.0f,  // Bottom-right
+        -1.0f,  1.0f,  // Top-left
+         1.0f,  1.0f   // Top-right
+    };
+    const unsigned int indices[] = {
+        0, 1, 2,  // First triangle
+        2, 1, 3   // Second triangle
+    };
+
+    glGenVertexArrays(1, &vertexArray_);
+    glGenBuffers(1, &vertexBuffer_);
+    glGenBuffers(1, &indexBuffer_);
+    glBindVertexArray(vertexArray_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // The index buffer stays with the vertex array
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+FullScreenQuad::~FullScreenQuad() {
+    glDeleteVertexArrays(1, &vertexArray_);
+    glDeleteBuffers(1, &vertexBuffer_);
+    glDeleteBuffers(1, &indexBuffer_);
+}
+
+void FullScreenQuad::draw() const {
+    glBindVertexArray(vertexArray_);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
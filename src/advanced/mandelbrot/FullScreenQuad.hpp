@@ -0,0 +1,20 @@
+#pragma once
+#include <glad/glad.h>
+
+// The quad every Mandelbrot shader is drawn with: two triangles over the whole viewport, the corners (-1 to 1) at
+// attribute 0 like mandelbrot.vert takes them. Owns the vertex array and its buffers, the context has to outlive it.
+class FullScreenQuad {
+    public:
+        FullScreenQuad();
+        ~FullScreenQuad();
+        FullScreenQuad(const FullScreenQuad&) = delete;
+        FullScreenQuad& operator=(const FullScreenQuad&) = delete;
+
+        // Binds the vertex array and draws the quad with the current program into the bound framebuffer
+        void draw() const;
+
+    private:
+        GLuint vertexArray_ = 0;
+        GLuint vertexBuffer_ = 0;
+        GLuint indexBuffer_ = 0;
+};
@@ -0,0 +1,174 @@
+#include "IterationBudget.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+void IterationStatistics::print(std::ostream& out) const {
+    out << "Iterations " << budget << ": " << interiorFraction * 100.0 << " % interior, " << unresolvedFraction * 100.0
+        << " % unresolved, " << nearLimitFraction * 100.0 << " % escaped in the upper half, 99.9 % escaped by "
+        << escapePercentile << ", full frame " << frameMilliseconds << " ms\n";
+    out << "Escape histogram (log2):";
+    for (std::size_t bucket = 0; bucket < histogram.size(); bucket++) {
+        if (histogram[bucket]) out << ' ' << bucket << ':' << histogram[bucket];
+    }
+    out << '\n';
+}
+
+IterationBudget::IterationBudget(int sampleSize) : sampleSize_(sampleSize) {
+    glGenTextures(1, &texture_);
+    glGenFramebuffers(1, &framebuffer_);
+    glGenBuffers(1, &buffer_);
+    glGenQueries(1, &timerQuery_);
+}
+
+IterationBudget::~IterationBudget() {
+    if (fence_) glDeleteSync(fence_);
+    glDeleteQueries(1, &timerQuery_);
+    glDeleteBuffers(1, &buffer_);
+    glDeleteFramebuffers(1, &framebuffer_);
+    glDeleteTextures(1, &texture_);
+}
+
+bool IterationBudget::measure(int width, int height, int budget, const SampleRenderer& render) {
+    if (fence_) return false;
+
+    // Whole pixels of the frame per sample, the grid covers the frame (and up to one sample more)
+    const int factor = std::max(1, (std::max(width, height) + sampleSize_ - 1) / sampleSize_);
+    const int sampleWidth = (width + factor - 1) / factor;
+    const int sampleHeight = (height + factor - 1) / factor;
+    if (sampleWidth != width_ || sampleHeight != height_) resize(sampleWidth, sampleHeight);
+    samplesPerPixel_ = static_cast<double>(sampleWidth) * sampleHeight / (static_cast<double>(width) * height);
+    budget_ = budget;
+
+    GLint previousFramebuffer;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, width_, height_);
+
+    glBeginQuery(GL_TIME_ELAPSED, timerQuery_);
+    render(width_, height_, factor);
+    glEndQuery(GL_TIME_ELAPSED);
+
+    // Queue the copy into the buffer, poll maps it once the fence signaled
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer_);
+    glReadPixels(0, 0, width_, height_, GL_RG, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    return true;
+}
+
+bool IterationBudget::poll() {
+    if (!fence_) return false;
+    GLenum status = glClientWaitSync(fence_, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(fence_);
+    fence_ = nullptr;
+    if (status == GL_WAIT_FAILED) return false;
+
+    // The fence covers the draw, so the query result is there as well
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(timerQuery_, GL_QUERY_RESULT, &nanoseconds);
+
+    const std::size_t count = static_cast<std::size_t>(width_) * height_;
+    std::vector<float> samples(2 * count);  // count, proven interior
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer_);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                          static_cast<GLsizeiptr>(samples.size() * sizeof(float)), GL_MAP_READ_BIT);
+    if (mapped) {
+        std::copy_n(static_cast<const float*>(mapped), samples.size(), samples.data());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        std::cerr << "Failed to map the iteration samples\n";
+        return false;
+    }
+
+    IterationStatistics statistics;
+    statistics.samples = static_cast<int>(count);
+    statistics.budget = budget_;
+    statistics.frameMilliseconds = nanoseconds / 1e6 / samplesPerPixel_;
+
+    std::vector<int> escaped;
+    escaped.reserve(count);
+    std::size_t interior = 0;
+    std::size_t unresolved = 0;
+    std::size_t nearLimit = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        const int iterations = static_cast<int>(samples[2 * i]);
+        if (iterations >= budget_) {
+            if (samples[2 * i + 1] != 0.0f) {
+                interior++;
+            } else {
+                unresolved++;
+            }
+            continue;
+        }
+        escaped.push_back(iterations);
+        if (2 * iterations >= budget_) nearLimit++;
+        int bucket = 0;
+        while ((static_cast<uint32_t>(iterations) + 1) >> (bucket + 1)) bucket++;
+        statistics.histogram[std::min<std::size_t>(bucket, statistics.histogram.size() - 1)]++;
+    }
+    statistics.interiorFraction = static_cast<double>(interior) / count;
+    statistics.unresolvedFraction = static_cast<double>(unresolved) / count;
+    statistics.nearLimitFraction = static_cast<double>(nearLimit) / count;
+    if (!escaped.empty()) {
+        auto percentile = escaped.begin() + static_cast<std::ptrdiff_t>((escaped.size() - 1) * 0.999);
+        std::nth_element(escaped.begin(), percentile, escaped.end());
+        statistics.escapePercentile = *percentile;
+    }
+
+    statistics_ = statistics;
+    passes_++;
+    adjust();
+    return true;
+}
+
+void IterationBudget::resize(int width, int height) {
+    width_ = width;
+    height_ = height;
+
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, width, height, 0, GL_RG, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previousFramebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer_);
+    glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 2 * sizeof(float), nullptr,
+                 GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void IterationBudget::adjust() {
+    const IterationStatistics& statistics = statistics_;
+    // The first pass also pays for compiling the shader on drivers that do it at the first draw
+    const double frameMilliseconds = passes_ > 1 ? statistics.frameMilliseconds : 0.0;
+    const bool overTime = frameMilliseconds > targetFrameMilliseconds_;
+    const bool roomToDouble = 2.0 * frameMilliseconds <= targetFrameMilliseconds_;
+    const bool cutOff = statistics.unresolvedFraction > targetUnresolvedFraction_ ||
+                        statistics.nearLimitFraction > targetNearLimitFraction_;
+    const bool excess = statistics.escapePercentile < budget_ / 4 &&
+                        statistics.unresolvedFraction <= targetUnresolvedFraction_ / 2;
+
+    // Doubling roughly doubles the frame time, so a limit halved for time doesn't qualify for doubling again
+    if (cutOff && roomToDouble) {
+        budget_ = std::min(budget_ * 2, maximumBudget_);
+    } else if (excess || overTime) {
+        budget_ = std::max(budget_ / 2, minimumBudget_);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+
+// What a sample pass found out about the view
+struct IterationStatistics {
+    int samples = 0;
+    int budget = 0;                   // iteration limit the samples were rendered with
+    double interiorFraction = 0.0;    // proven to never escape by the interior checks
+    double unresolvedFraction = 0.0;  // reached the limit without such a proof
+    double nearLimitFraction = 0.0;   // escaped in the upper half of the limit, half the limit would have lost them
+    int escapePercentile = 0;         // 99.9th percentile of the escaped counts
+    double frameMilliseconds = 0.0;   // GPU time of a full frame, extrapolated from the sample pass
+    std::array<std::size_t, 32> histogram{};  // escaped samples by floor(log2(i + 1))
+
+    void print(std::ostream& out) const;
+};
+
+// Picks the iteration limit from the image instead of a fixed number. A pass renders the view on a coarse grid (the
+// longer side sampleSize pixels) as raw iteration counts into a float target, read back through a pixel buffer
+// object a frame or two later, so it never stalls the render loop. From the histogram:
+//
+// - Samples at the limit that the interior checks didn't prove to be inside the set may still escape, and many
+//   escapes in the upper half of the limit mean more just past it. If either fraction is above its target, the
+//   limit doubles, unless the full frame would then take too long.
+// - If 99.9% of the escaped samples need less than a quarter of the limit and few are unresolved, the rest is spent
+//   on interior points only and the limit halves. It also halves when the frame time is over the target.
+//
+// The limit moves by factors of two, the rules are exclusive so it settles instead of oscillating. Perturbation has
+// no interior checks, there everything at the limit counts as unresolved.
+class IterationBudget {
+    public:
+        // Highest limit of any mode, iteration counts stay exact in the float targets up to it
+        static constexpr int maximumIterations = 1 << 22;
+
+        // Draws the view into the bound framebuffer with the pixel size factor times larger and the given resolution.
+        // The View block needs u_paletteLength < 0, the programs then write the raw count to red and the interior
+        // proof to green.
+        using SampleRenderer = std::function<void(int width, int height, int factor)>;
+
+        explicit IterationBudget(int sampleSize = 128);
+        ~IterationBudget();
+        IterationBudget(const IterationBudget&) = delete;
+        IterationBudget& operator=(const IterationBudget&) = delete;
+
+        // Starts a sample pass of a width x height frame rendered with the limit budget. Does nothing (returns false)
+        // while the previous pass is still in flight.
+        bool measure(int width, int height, int budget, const SampleRenderer& render);
+
+        // Collects a finished pass, returns whether new statistics arrived. budget() has the limit they suggest.
+        bool poll();
+
+        bool pending() const { return fence_ != nullptr; }
+        int budget() const { return budget_; }
+        const IterationStatistics& statistics() const { return statistics_; }
+        std::size_t passes() const { return passes_; }
+
+        void setTargets(double unresolvedFraction, double nearLimitFraction, double frameMilliseconds) {
+            targetUnresolvedFraction_ = unresolvedFraction;
+            targetNearLimitFraction_ = nearLimitFraction;
+            targetFrameMilliseconds_ = frameMilliseconds;
+        }
+        void setLimits(int minimum, int maximum) {
+            minimumBudget_ = minimum;
+            maximumBudget_ = maximum;
+        }
+
+    private:
+        void resize(int width, int height);
+        void adjust();
+
+        int sampleSize_;
+        GLuint texture_ = 0;
+        GLuint framebuffer_ = 0;
+        GLuint buffer_ = 0;
+        GLuint timerQuery_ = 0;
+        GLsync fence_ = nullptr;
+        int width_ = 0;  // of the sample grid
+        int height_ = 0;
+        double samplesPerPixel_ = 0.0;
+
+        int budget_ = 0;
+        int minimumBudget_ = 64;
+        int maximumBudget_ = maximumIterations;
+        double targetUnresolvedFraction_ = 0.01;
+        double targetNearLimitFraction_ = 0.001;
+        double targetFrameMilliseconds_ = 100.0;
+        IterationStatistics statistics_;
+        std::size_t passes_ = 0;
+};
@@ -0,0 +1,92 @@
+#include "KeyframeZoom.hpp"
+
+#include <ShaderUtils.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "MandelbrotShaders.hpp"
+
+KeyframeZoom::KeyframeZoom(int width, int height, int oversample, KeyframeRenderer renderer)
+    : width_(width), height_(height), oversample_(oversample), renderer_(std::move(renderer)) {
+    std::string vertexSource = mandelbrotShaderSource("mandelbrot.vert");
+    std::string resampleSource = mandelbrotShaderSource("keyframe_resample.frag");
+    program_ = createShaderProgram(vertexSource.c_str(), resampleSource.c_str());
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "u_outer"), 0);
+    glUniform1i(glGetUniformLocation(program_, "u_inner"), 1);
+    glUseProgram(0);
+    uniforms_ = std::make_unique<UniformBinding>(program_);
+    resolutionLocation_ = uniforms_->location("u_resolution");
+    outerScaleLocation_ = uniforms_->location("u_outerScale");
+
+    // Mipmapped, a frame shows a keyframe at 1 to 2 texels per pixel
+    glGenTextures(2, textures_);
+    glGenFramebuffers(2, framebuffers_);
+    GLint previousFramebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    for (int i = 0; i < 2; i++) {
+        glBindTexture(GL_TEXTURE_2D, textures_[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, keyframeWidth(), keyframeHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures_[i], 0);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+KeyframeZoom::~KeyframeZoom() {
+    glDeleteFramebuffers(2, framebuffers_);
+    glDeleteTextures(2, textures_);
+    glDeleteProgram(program_);
+}
+
+void KeyframeZoom::drawFrame(const FullScreenQuad& quad, double zoom) {
+    const int keyframe = static_cast<int>(std::floor(zoom));
+    const int outer = acquire(keyframe, -1);
+    const int inner = acquire(keyframe + 1, outer);
+
+    glUseProgram(program_);
+    uniforms_->set(resolutionLocation_, static_cast<float>(width_), static_cast<float>(height_));
+    uniforms_->set(outerScaleLocation_, static_cast<float>(std::exp2(keyframe - zoom)));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, textures_[outer]);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, textures_[inner]);
+    quad.draw();
+    glActiveTexture(GL_TEXTURE0);
+    drawnFrames_++;
+}
+
+int KeyframeZoom::acquire(int keyframe, int keep) {
+    for (int slot = 0; slot < 2; slot++) {
+        if (keyframes_[slot] == keyframe) return slot;
+    }
+
+    // Replace the keyframe farther away from the one needed
+    int slot = std::abs(keyframes_[0] - keyframe) >= std::abs(keyframes_[1] - keyframe) ? 0 : 1;
+    if (slot == keep) slot = 1 - slot;
+
+    GLint previousFramebuffer;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_[slot]);
+    glViewport(0, 0, keyframeWidth(), keyframeHeight());
+    renderer_(keyframe, keyframeWidth(), keyframeHeight());
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+
+    glBindTexture(GL_TEXTURE_2D, textures_[slot]);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    keyframes_[slot] = keyframe;
+    renderedKeyframes_++;
+    return slot;
+}
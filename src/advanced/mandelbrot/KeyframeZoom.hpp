@@ -0,0 +1,54 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <UniformBinding.hpp>
+#include <functional>
+#include <memory>
+
+#include "FullScreenQuad.hpp"
+
+// Builds the frames of a zoom animation from keyframes instead of rendering each of them. Keyframe k shows the view
+// zoomed in by 2^k, rendered at oversample times the frame size. A frame at zoom z (k <= z < k + 1) is resampled from
+// keyframe k, whose middle 2^(k - z) of the width it shows, with keyframe k + 1 on top where that one reaches. Both
+// have at least one texel per frame pixel, so nothing is ever magnified.
+//
+// Keyframes are rendered on demand by the callback, the last two are kept. Zooming in (or out) monotonically renders
+// every keyframe exactly once.
+class KeyframeZoom {
+    public:
+        // Draws keyframe k into the bound framebuffer, the viewport is already set to the keyframe size
+        using KeyframeRenderer = std::function<void(int keyframe, int width, int height)>;
+
+        KeyframeZoom(int width, int height, int oversample, KeyframeRenderer renderer);
+        ~KeyframeZoom();
+        KeyframeZoom(const KeyframeZoom&) = delete;
+        KeyframeZoom& operator=(const KeyframeZoom&) = delete;
+
+        // Draws the frame at zoom (>= 0) into the bound framebuffer, rendering the keyframes it needs first
+        void drawFrame(const FullScreenQuad& quad, double zoom);
+
+        int keyframeWidth() const { return width_ * oversample_; }
+        int keyframeHeight() const { return height_ * oversample_; }
+        std::size_t renderedKeyframes() const { return renderedKeyframes_; }
+        std::size_t drawnFrames() const { return drawnFrames_; }
+
+    private:
+        // Slot holding keyframe k, rendered if it isn't there yet. keep is a slot that must not be replaced.
+        int acquire(int keyframe, int keep);
+
+        int width_;
+        int height_;
+        int oversample_;
+        KeyframeRenderer renderer_;
+
+        GLuint program_ = 0;
+        std::unique_ptr<UniformBinding> uniforms_;
+        GLint resolutionLocation_ = -1;
+        GLint outerScaleLocation_ = -1;
+
+        GLuint textures_[2] = {0, 0};
+        GLuint framebuffers_[2] = {0, 0};
+        int keyframes_[2] = {-1, -1};  // which keyframe each slot holds
+        std::size_t renderedKeyframes_ = 0;
+        std::size_t drawnFrames_ = 0;
+};
@@ -0,0 +1,95 @@
+#include <immintrin.h>
+
+#include "CpuMandelbrot.hpp"
+
+namespace {
+    // Same test as the scalar kernel, all lanes set where c is in the main cardioid or the period-2 bulb
+    __m256 insideCardioidOrBulb(__m256 x, __m256 y) {
+        const __m256 yy = _mm256_mul_ps(y, y);
+        const __m256 xq = _mm256_sub_ps(x, _mm256_set1_ps(0.25f));
+        const __m256 q = _mm256_add_ps(_mm256_mul_ps(xq, xq), yy);
+        const __m256 quartic = _mm256_mul_ps(q, _mm256_add_ps(q, xq));
+        const __m256 cardioid = _mm256_cmp_ps(quartic, _mm256_mul_ps(_mm256_set1_ps(0.25f), yy), _CMP_LE_OQ);
+        const __m256 xb = _mm256_add_ps(x, _mm256_set1_ps(1.0f));
+        const __m256 bulb = _mm256_add_ps(_mm256_mul_ps(xb, xb), yy);
+        return _mm256_or_ps(cardioid, _mm256_cmp_ps(bulb, _mm256_set1_ps(0.0625f), _CMP_LE_OQ));
+    }
+}
+
+// 8 pixels per instruction. Lanes that escaped keep their z (masked update) and stop counting.
+void iterateTileAvx2(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ) {
+    constexpr int lanes = 8;
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 halfWidth = _mm256_set1_ps(static_cast<float>(params.width) / 2.0f);
+    const __m256 scale = _mm256_set1_ps(params.scale);
+    const __m256 centerX = _mm256_set1_ps(params.centerX);
+    const __m256i maxIterations = _mm256_set1_epi32(params.maxIterations);
+    const __m256 laneOffsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const float halfHeight = static_cast<float>(params.height) / 2.0f;
+
+    alignas(32) uint32_t counts[lanes];
+    alignas(32) float lastX[lanes];
+    alignas(32) float lastY[lanes];
+    for (int y = tile.y; y < tile.y + tile.height; y++) {
+        const __m256 cy = _mm256_set1_ps((static_cast<float>(y) + 0.5f - halfHeight) * params.scale + params.centerY);
+        for (int x = tile.x; x < tile.x + tile.width; x += lanes) {
+            const __m256 fragX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x) + 0.5f), laneOffsets);
+            const __m256 cx = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(fragX, halfWidth), scale), centerX);
+
+            __m256 zx = _mm256_setzero_ps();
+            __m256 zy = _mm256_setzero_ps();
+            __m256 savedX = _mm256_setzero_ps();
+            __m256 savedY = _mm256_setzero_ps();
+            __m256i count = _mm256_setzero_si256();
+            __m256 active = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+            // Interior lanes are done before they start
+            __m256 interior = _mm256_setzero_ps();
+            if (params.interiorChecks) interior = insideCardioidOrBulb(cx, cy);
+            active = _mm256_andnot_ps(interior, active);
+
+            for (int i = 0; i < params.maxIterations; i++) {
+                const __m256 xx = _mm256_mul_ps(zx, zx);
+                const __m256 yy = _mm256_mul_ps(zy, zy);
+                // !(|z|^2 > 4), so NaN keeps iterating exactly like the shader's break condition
+                active = _mm256_and_ps(active, _mm256_cmp_ps(_mm256_add_ps(xx, yy), four, _CMP_NGT_UQ));
+                if (_mm256_movemask_ps(active) == 0) break;
+                count = _mm256_sub_epi32(count, _mm256_castps_si256(active));
+
+                const __m256 nextX = _mm256_add_ps(_mm256_sub_ps(xx, yy), cx);
+                const __m256 nextY = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(zx, zx), zy), cy);
+                zx = _mm256_blendv_ps(zx, nextX, active);
+                zy = _mm256_blendv_ps(zy, nextY, active);
+
+                if (!params.interiorChecks) continue;
+                const __m256 repeated =
+                    _mm256_and_ps(_mm256_cmp_ps(zx, savedX, _CMP_EQ_OQ), _mm256_cmp_ps(zy, savedY, _CMP_EQ_OQ));
+                const __m256 periodic = _mm256_and_ps(active, repeated);
+                interior = _mm256_or_ps(interior, periodic);
+                active = _mm256_andnot_ps(periodic, active);
+                const uint32_t done = static_cast<uint32_t>(i) + 1;
+                if ((done & (done - 1)) == 0) {
+                    savedX = zx;
+                    savedY = zy;
+                }
+            }
+
+            // Interior and periodic lanes would have run to the end
+            count = _mm256_castps_si256(
+                _mm256_blendv_ps(_mm256_castsi256_ps(count), _mm256_castsi256_ps(maxIterations), interior));
+
+            _mm256_store_si256(reinterpret_cast<__m256i*>(counts), count);
+            uint32_t* row = iterations + static_cast<std::size_t>(y) * params.width;
+            for (int lane = 0; lane < lanes && x + lane < tile.x + tile.width; lane++) row[x + lane] = counts[lane];
+            if (escapeZ) {
+                _mm256_store_ps(lastX, zx);
+                _mm256_store_ps(lastY, zy);
+                float* rowZ = escapeZ + 2 * (static_cast<std::size_t>(y) * params.width);
+                for (int lane = 0; lane < lanes && x + lane < tile.x + tile.width; lane++) {
+                    rowZ[2 * (x + lane)] = lastX[lane];
+                    rowZ[2 * (x + lane) + 1] = lastY[lane];
+                }
+            }
+        }
+    }
+}
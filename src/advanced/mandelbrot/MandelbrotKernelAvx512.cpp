@@ -0,0 +1,93 @@
+#include <immintrin.h>
+
+#include "CpuMandelbrot.hpp"
+
+namespace {
+    // Same test as the scalar kernel, set bits where c is in the main cardioid or the period-2 bulb
+    __mmask16 insideCardioidOrBulb(__m512 x, __m512 y) {
+        const __m512 yy = _mm512_mul_ps(y, y);
+        const __m512 xq = _mm512_sub_ps(x, _mm512_set1_ps(0.25f));
+        const __m512 q = _mm512_add_ps(_mm512_mul_ps(xq, xq), yy);
+        const __m512 quartic = _mm512_mul_ps(q, _mm512_add_ps(q, xq));
+        const __mmask16 cardioid = _mm512_cmp_ps_mask(quartic, _mm512_mul_ps(_mm512_set1_ps(0.25f), yy), _CMP_LE_OQ);
+        const __m512 xb = _mm512_add_ps(x, _mm512_set1_ps(1.0f));
+        const __m512 bulb = _mm512_add_ps(_mm512_mul_ps(xb, xb), yy);
+        return cardioid | _mm512_cmp_ps_mask(bulb, _mm512_set1_ps(0.0625f), _CMP_LE_OQ);
+    }
+}
+
+// 16 pixels per instruction, the active lanes live in a mask register
+void iterateTileAvx512(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ) {
+    constexpr int lanes = 16;
+    const __m512 four = _mm512_set1_ps(4.0f);
+    const __m512 halfWidth = _mm512_set1_ps(static_cast<float>(params.width) / 2.0f);
+    const __m512 scale = _mm512_set1_ps(params.scale);
+    const __m512 centerX = _mm512_set1_ps(params.centerX);
+    const __m512 laneOffsets = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                                              8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i maxIterations = _mm512_set1_epi32(params.maxIterations);
+    const float halfHeight = static_cast<float>(params.height) / 2.0f;
+
+    alignas(64) uint32_t counts[lanes];
+    alignas(64) float lastX[lanes];
+    alignas(64) float lastY[lanes];
+    for (int y = tile.y; y < tile.y + tile.height; y++) {
+        const __m512 cy = _mm512_set1_ps((static_cast<float>(y) + 0.5f - halfHeight) * params.scale + params.centerY);
+        for (int x = tile.x; x < tile.x + tile.width; x += lanes) {
+            const __m512 fragX = _mm512_add_ps(_mm512_set1_ps(static_cast<float>(x) + 0.5f), laneOffsets);
+            const __m512 cx = _mm512_add_ps(_mm512_mul_ps(_mm512_sub_ps(fragX, halfWidth), scale), centerX);
+
+            __m512 zx = _mm512_setzero_ps();
+            __m512 zy = _mm512_setzero_ps();
+            __m512 savedX = _mm512_setzero_ps();
+            __m512 savedY = _mm512_setzero_ps();
+            __m512i count = _mm512_setzero_si512();
+
+            // Interior lanes are done before they start
+            __mmask16 interior = params.interiorChecks ? insideCardioidOrBulb(cx, cy) : 0;
+            __mmask16 active = ~interior;
+
+            for (int i = 0; i < params.maxIterations; i++) {
+                const __m512 xx = _mm512_mul_ps(zx, zx);
+                const __m512 yy = _mm512_mul_ps(zy, zy);
+                // !(|z|^2 > 4), so NaN keeps iterating exactly like the shader's break condition
+                active = _mm512_mask_cmp_ps_mask(active, _mm512_add_ps(xx, yy), four, _CMP_NGT_UQ);
+                if (active == 0) break;
+                count = _mm512_mask_add_epi32(count, active, count, one);
+
+                const __m512 nextX = _mm512_add_ps(_mm512_sub_ps(xx, yy), cx);
+                const __m512 nextY = _mm512_add_ps(_mm512_mul_ps(_mm512_add_ps(zx, zx), zy), cy);
+                zx = _mm512_mask_mov_ps(zx, active, nextX);
+                zy = _mm512_mask_mov_ps(zy, active, nextY);
+
+                if (!params.interiorChecks) continue;
+                const __mmask16 periodic = _mm512_mask_cmp_ps_mask(active, zx, savedX, _CMP_EQ_OQ) &
+                                           _mm512_mask_cmp_ps_mask(active, zy, savedY, _CMP_EQ_OQ);
+                interior |= periodic;
+                active &= ~periodic;
+                const uint32_t done = static_cast<uint32_t>(i) + 1;
+                if ((done & (done - 1)) == 0) {
+                    savedX = zx;
+                    savedY = zy;
+                }
+            }
+
+            // Interior and periodic lanes would have run to the end
+            count = _mm512_mask_mov_epi32(count, interior, maxIterations);
+
+            _mm512_store_si512(counts, count);
+            uint32_t* row = iterations + static_cast<std::size_t>(y) * params.width;
+            for (int lane = 0; lane < lanes && x + lane < tile.x + tile.width; lane++) row[x + lane] = counts[lane];
+            if (escapeZ) {
+                _mm512_store_ps(lastX, zx);
+                _mm512_store_ps(lastY, zy);
+                float* rowZ = escapeZ + 2 * (static_cast<std::size_t>(y) * params.width);
+                for (int lane = 0; lane < lanes && x + lane < tile.x + tile.width; lane++) {
+                    rowZ[2 * (x + lane)] = lastX[lane];
+                    rowZ[2 * (x + lane) + 1] = lastY[lane];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#include "CpuMandelbrot.hpp"
+
+namespace {
+    // One instantiation per family and power: complexPower unrolls z^Power and Julia is a constant, so the loop has no
+    // pow() and no branch on the formula. Same loop as iterateTileScalar otherwise, without the cardioid/bulb test
+    // (that one is only valid for z^2 + c), and the same operations as the shaders of FractalPrograms.
+    template <int Power, bool Julia>
+    void iterateTileFormula(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ) {
+        const float halfWidth = static_cast<float>(params.width) / 2.0f;
+        const float halfHeight = static_cast<float>(params.height) / 2.0f;
+
+        for (int y = tile.y; y < tile.y + tile.height; y++) {
+            const float pixelY = (static_cast<float>(y) + 0.5f - halfHeight) * params.scale + params.centerY;
+            for (int x = tile.x; x < tile.x + tile.width; x++) {
+                const float pixelX = (static_cast<float>(x) + 0.5f - halfWidth) * params.scale + params.centerX;
+                const float cx = Julia ? params.formula.juliaX : pixelX;
+                const float cy = Julia ? params.formula.juliaY : pixelY;
+
+                float zx = Julia ? pixelX : 0.0f;
+                float zy = Julia ? pixelY : 0.0f;
+                float savedX = 0.0f;
+                float savedY = 0.0f;
+                int i = 0;
+                for (; i < params.maxIterations; i++) {
+                    if (zx * zx + zy * zy > 4.0f) break;
+                    float powerX;
+                    float powerY;
+                    complexPower<Power>(zx, zy, powerX, powerY);
+                    zx = powerX + cx;
+                    zy = powerY + cy;
+
+                    if (!params.interiorChecks) continue;
+                    if (zx == savedX && zy == savedY) {
+                        i = params.maxIterations;  // periodic
+                        break;
+                    }
+                    const uint32_t done = static_cast<uint32_t>(i) + 1;
+                    if ((done & (done - 1)) == 0) {
+                        savedX = zx;
+                        savedY = zy;
+                    }
+                }
+                const std::size_t index = static_cast<std::size_t>(y) * params.width + x;
+                iterations[index] = static_cast<uint32_t>(i);
+                if (escapeZ) {
+                    escapeZ[2 * index] = zx;
+                    escapeZ[2 * index + 1] = zy;
+                }
+            }
+        }
+    }
+
+    // [power - minFractalPower][Julia]
+    const MandelbrotKernel formulaKernels[][2] = {
+        {iterateTileFormula<2, false>, iterateTileFormula<2, true>},
+        {iterateTileFormula<3, false>, iterateTileFormula<3, true>},
+        {iterateTileFormula<4, false>, iterateTileFormula<4, true>},
+        {iterateTileFormula<5, false>, iterateTileFormula<5, true>},
+        {iterateTileFormula<6, false>, iterateTileFormula<6, true>},
+        {iterateTileFormula<7, false>, iterateTileFormula<7, true>},
+        {iterateTileFormula<8, false>, iterateTileFormula<8, true>},
+    };
+    static_assert(sizeof(formulaKernels) / sizeof(formulaKernels[0]) == maxFractalPower - minFractalPower + 1,
+                  "one row per power");
+}
+
+MandelbrotKernel formulaKernelFor(const FractalFormula& formula) {
+    const int power = formula.power < minFractalPower || formula.power > maxFractalPower ? 2 : formula.power;
+    return formulaKernels[power - minFractalPower][formula.family == FractalFamily::Julia ? 1 : 0];
+}
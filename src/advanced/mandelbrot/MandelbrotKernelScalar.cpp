@@ -0,0 +1,54 @@
+#include "CpuMandelbrot.hpp"
+
+namespace {
+    // Main cardioid: q * (q + x - 1/4) <= y^2 / 4 with q = (x - 1/4)^2 + y^2, period-2 bulb: (x + 1)^2 + y^2 <= 1/16
+    bool insideCardioidOrBulb(float x, float y) {
+        const float yy = y * y;
+        const float xq = x - 0.25f;
+        const float q = xq * xq + yy;
+        const float xb = x + 1.0f;
+        return q * (q + xq) <= 0.25f * yy || xb * xb + yy <= 0.0625f;
+    }
+}
+
+void iterateTileScalar(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ) {
+    const float halfWidth = static_cast<float>(params.width) / 2.0f;
+    const float halfHeight = static_cast<float>(params.height) / 2.0f;
+
+    for (int y = tile.y; y < tile.y + tile.height; y++) {
+        // c = u_center + (gl_FragCoord.xy - u_resolution / 2.0) * u_scale
+        const float cy = (static_cast<float>(y) + 0.5f - halfHeight) * params.scale + params.centerY;
+        for (int x = tile.x; x < tile.x + tile.width; x++) {
+            const float cx = (static_cast<float>(x) + 0.5f - halfWidth) * params.scale + params.centerX;
+
+            float zx = 0.0f;
+            float zy = 0.0f;
+            float savedX = 0.0f;
+            float savedY = 0.0f;
+            int i = params.interiorChecks && insideCardioidOrBulb(cx, cy) ? params.maxIterations : 0;
+            for (; i < params.maxIterations; i++) {
+                if (zx * zx + zy * zy > 4.0f) break;
+                const float nextX = zx * zx - zy * zy + cx;
+                zy = 2.0f * zx * zy + cy;
+                zx = nextX;
+
+                if (!params.interiorChecks) continue;
+                if (zx == savedX && zy == savedY) {
+                    i = params.maxIterations;  // periodic
+                    break;
+                }
+                const uint32_t done = static_cast<uint32_t>(i) + 1;
+                if ((done & (done - 1)) == 0) {
+                    savedX = zx;
+                    savedY = zy;
+                }
+            }
+            const std::size_t index = static_cast<std::size_t>(y) * params.width + x;
+            iterations[index] = static_cast<uint32_t>(i);
+            if (escapeZ) {
+                escapeZ[2 * index] = zx;
+                escapeZ[2 * index + 1] = zy;
+            }
+        }
+    }
+}
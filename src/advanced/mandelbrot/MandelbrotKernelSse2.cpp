@@ -0,0 +1,95 @@
+#include <emmintrin.h>
+
+#include "CpuMandelbrot.hpp"
+
+namespace {
+    __m128 select(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+    // Same test as the scalar kernel, all lanes set where c is in the main cardioid or the period-2 bulb
+    __m128 insideCardioidOrBulb(__m128 x, __m128 y) {
+        const __m128 yy = _mm_mul_ps(y, y);
+        const __m128 xq = _mm_sub_ps(x, _mm_set1_ps(0.25f));
+        const __m128 q = _mm_add_ps(_mm_mul_ps(xq, xq), yy);
+        const __m128 cardioid = _mm_cmple_ps(_mm_mul_ps(q, _mm_add_ps(q, xq)), _mm_mul_ps(_mm_set1_ps(0.25f), yy));
+        const __m128 xb = _mm_add_ps(x, _mm_set1_ps(1.0f));
+        const __m128 bulb = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(xb, xb), yy), _mm_set1_ps(0.0625f));
+        return _mm_or_ps(cardioid, bulb);
+    }
+}
+
+// 4 pixels per instruction. Lanes that escaped keep their z (masked update) and stop counting.
+void iterateTileSse2(const MandelbrotParams& params, const Tile& tile, uint32_t* iterations, float* escapeZ) {
+    constexpr int lanes = 4;
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 halfWidth = _mm_set1_ps(static_cast<float>(params.width) / 2.0f);
+    const __m128 scale = _mm_set1_ps(params.scale);
+    const __m128 centerX = _mm_set1_ps(params.centerX);
+    const __m128i maxIterations = _mm_set1_epi32(params.maxIterations);
+    const float halfHeight = static_cast<float>(params.height) / 2.0f;
+
+    alignas(16) uint32_t counts[lanes];
+    alignas(16) float lastX[lanes];
+    alignas(16) float lastY[lanes];
+    for (int y = tile.y; y < tile.y + tile.height; y++) {
+        const __m128 cy = _mm_set1_ps((static_cast<float>(y) + 0.5f - halfHeight) * params.scale + params.centerY);
+        for (int x = tile.x; x < tile.x + tile.width; x += lanes) {
+            const float fx = static_cast<float>(x) + 0.5f;
+            const __m128 fragX = _mm_setr_ps(fx, fx + 1.0f, fx + 2.0f, fx + 3.0f);
+            const __m128 cx = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(fragX, halfWidth), scale), centerX);
+
+            __m128 zx = _mm_setzero_ps();
+            __m128 zy = _mm_setzero_ps();
+            __m128 savedX = _mm_setzero_ps();
+            __m128 savedY = _mm_setzero_ps();
+            __m128i count = _mm_setzero_si128();
+            __m128 active = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+            // Interior lanes are done before they start
+            __m128 interior = _mm_setzero_ps();
+            if (params.interiorChecks) interior = insideCardioidOrBulb(cx, cy);
+            active = _mm_andnot_ps(interior, active);
+
+            for (int i = 0; i < params.maxIterations; i++) {
+                const __m128 xx = _mm_mul_ps(zx, zx);
+                const __m128 yy = _mm_mul_ps(zy, zy);
+                // !(|z|^2 > 4), so NaN keeps iterating exactly like the shader's break condition
+                active = _mm_and_ps(active, _mm_cmpngt_ps(_mm_add_ps(xx, yy), four));
+                if (_mm_movemask_ps(active) == 0) break;
+                count = _mm_sub_epi32(count, _mm_castps_si128(active));
+
+                const __m128 nextX = _mm_add_ps(_mm_sub_ps(xx, yy), cx);
+                const __m128 nextY = _mm_add_ps(_mm_mul_ps(_mm_add_ps(zx, zx), zy), cy);
+                zx = select(active, nextX, zx);
+                zy = select(active, nextY, zy);
+
+                if (!params.interiorChecks) continue;
+                const __m128 periodic =
+                    _mm_and_ps(active, _mm_and_ps(_mm_cmpeq_ps(zx, savedX), _mm_cmpeq_ps(zy, savedY)));
+                interior = _mm_or_ps(interior, periodic);
+                active = _mm_andnot_ps(periodic, active);
+                const uint32_t done = static_cast<uint32_t>(i) + 1;
+                if ((done & (done - 1)) == 0) {
+                    savedX = zx;
+                    savedY = zy;
+                }
+            }
+
+            // Interior and periodic lanes would have run to the end
+            const __m128i interiorMask = _mm_castps_si128(interior);
+            count = _mm_or_si128(_mm_and_si128(interiorMask, maxIterations), _mm_andnot_si128(interiorMask, count));
+
+            _mm_store_si128(reinterpret_cast<__m128i*>(counts), count);
+            uint32_t* row = iterations + static_cast<std::size_t>(y) * params.width;
+            for (int lane = 0; lane < lanes && x + lane < tile.x + tile.width; lane++) row[x + lane] = counts[lane];
+            if (escapeZ) {
+                _mm_store_ps(lastX, zx);
+                _mm_store_ps(lastY, zy);
+                float* rowZ = escapeZ + 2 * (static_cast<std::size_t>(y) * params.width);
+                for (int lane = 0; lane < lanes && x + lane < tile.x + tile.width; lane++) {
+                    rowZ[2 * (x + lane)] = lastX[lane];
+                    rowZ[2 * (x + lane) + 1] = lastY[lane];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include "MandelbrotPrograms.hpp"
+
+#include <ShaderUtils.hpp>
+
+#include "MandelbrotShaders.hpp"
+#include "MandelbrotView.hpp"
+
+namespace {
+    // Permutation of a variant
+    ShaderDefines variantDefines(Precision precision, bool distanceEstimation) {
+        ShaderDefines defines;
+        if (precision == Precision::DoubleFloat) defines["PRECISION_DOUBLE_FLOAT"];
+        if (precision == Precision::Double) defines["PRECISION_DOUBLE"];
+        if (distanceEstimation) defines["DISTANCE_ESTIMATION"];
+        return defines;
+    }
+
+    // Every variant of the View block gets the same binding and palette unit
+    void setupVariant(GLuint program) {
+        glUniformBlockBinding(program, glGetUniformBlockIndex(program, "View"), mandelbrotViewBinding);
+
+        GLint previousProgram;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "u_palette"), mandelbrotPaletteUnit);
+        glUseProgram(previousProgram);
+    }
+}
+
+Precision precisionForScale(double scale, Precision extended) {
+    if (scale >= singlePrecisionScale) return Precision::Single;
+    if (scale >= extendedPrecisionScale) return extended;
+    return Precision::Perturbation;
+}
+
+const char* precisionName(Precision precision) {
+    switch (precision) {
+        case Precision::DoubleFloat: return "df64";
+        case Precision::Double: return "double";
+        case Precision::Perturbation: return "perturbation";
+        default: return "float";
+    }
+}
+
+MandelbrotPrograms::MandelbrotPrograms()
+    : permutations_(preprocessor_,
+                    {{GL_VERTEX_SHADER, "mandelbrot.vert"}, {GL_FRAGMENT_SHADER, "mandelbrot.frag"}},
+                    setupVariant) {
+    addMandelbrotShaders(preprocessor_);
+
+    // The escape time variants are needed right away, distance estimation when E is pressed
+    permutations_.prewarm({variantDefines(Precision::Single, false),
+                           variantDefines(Precision::DoubleFloat, false),
+                           variantDefines(Precision::Double, false)});
+}
+
+GLuint MandelbrotPrograms::program(Precision precision, bool distanceEstimation) {
+    return permutations_.program(variantDefines(precision, distanceEstimation));
+}
+
+bool MandelbrotPrograms::failed(Precision precision, bool distanceEstimation) {
+    return shaderProgramFailed(program(precision, distanceEstimation));
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <ShaderPermutationCache.hpp>
+#include <ShaderPreprocessor.hpp>
+
+// Arithmetic the Mandelbrot fragment shader iterates with. Single is plain float, DoubleFloat emulates a 48 bit
+// mantissa with pairs of floats (df64), Double uses the fp64 types of GLSL 4.00. Perturbation is DeepZoom.
+enum class Precision { Single, DoubleFloat, Double, Perturbation };
+
+// Smallest pixel size single precision resolves, below it the extended precisions take over
+constexpr double singlePrecisionScale = 1e-6;
+// Smallest pixel size the extended precisions resolve (the center is passed as two floats), below it perturbation
+constexpr double extendedPrecisionScale = 1e-12;
+
+// Cheapest precision for the pixel size, extended (DoubleFloat or Double) is used between the two limits
+Precision precisionForScale(double scale, Precision extended = Precision::DoubleFloat);
+const char* precisionName(Precision precision);
+
+// The full-frame Mandelbrot shader (mandelbrot.frag, see MandelbrotShaders.hpp), compiled once per precision. The
+// variants come from the same source, a #define selects the arithmetic: they are permutations of a
+// ShaderPermutationCache, the source includes the coloring and the interior checks. All of them use the View block.
+//
+// The distance estimation variants track dz/dc next to z and shade by the estimated distance to the boundary, which
+// draws the filaments anti-aliased with one sample per pixel. Pixels closer to the boundary than
+// u_supersampleThreshold pixels are sampled again on a u_supersamples x u_supersamples grid. They are compiled the
+// first time they are asked for.
+//
+// The programs are built through the active ShaderBuildQueue, shaderProgramReady tells when one is done and
+// shaderProgramFailed whether it has errors. A permutation that couldn't be preprocessed is 0.
+class MandelbrotPrograms {
+    public:
+        MandelbrotPrograms();
+        MandelbrotPrograms(const MandelbrotPrograms&) = delete;
+        MandelbrotPrograms& operator=(const MandelbrotPrograms&) = delete;
+
+        // Single, DoubleFloat or Double
+        GLuint program(Precision precision, bool distanceEstimation = false);
+        // Whether that program is done building and can't be drawn with
+        bool failed(Precision precision, bool distanceEstimation = false);
+
+        // The shader files changed (see watchMandelbrotShaders): builds the programs again, update swaps them in
+        // between frames once they are linked. See ShaderPermutationCache::reload.
+        void reload() { permutations_.reload(); }
+        bool update() { return permutations_.update(); }
+
+        const ShaderPermutationCache& permutations() const { return permutations_; }
+
+    private:
+        ShaderPreprocessor preprocessor_;
+        ShaderPermutationCache permutations_;
+};
@@ -0,0 +1,68 @@
+#include <ShaderPreprocessor.hpp>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "FractalFormula.hpp"
+
+// Build tool: writes a Mandelbrot shader the way the programs compile it, with the includes expanded and the defines
+// injected by ShaderPreprocessor, so glslangValidator can check every permutation at build time (see CMakeLists.txt).
+//
+// Usage: MandelbrotShaderExpand DIRECTORY OUTPUT NAME [DEFINE[=VALUE]...] [--formula julia3]
+//
+// NAME is a shader file of DIRECTORY. --formula gives fractal.frag the fractal_formula.glsl of that formula (family and
+// power, see FractalFormula) like FractalPrograms does.
+
+int main(int argc, char** argv) {
+    std::string positional[3];
+    int positionalCount = 0;
+    ShaderDefines defines;
+    std::string formulaName;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--formula" && i + 1 < argc) {
+            formulaName = argv[++i];
+        } else if (positionalCount < 3) {
+            positional[positionalCount++] = arg;
+        } else {
+            std::size_t equals = arg.find('=');
+            defines[arg.substr(0, equals)] = equals == std::string::npos ? std::string() : arg.substr(equals + 1);
+        }
+    }
+    if (positionalCount < 3) {
+        std::cerr << "Usage: MandelbrotShaderExpand DIRECTORY OUTPUT NAME [DEFINE[=VALUE]...] [--formula julia3]\n";
+        return -1;
+    }
+
+    ShaderPreprocessor preprocessor;
+    if (!formulaName.empty()) {
+        FractalFormula formula;
+        bool found = false;
+        for (FractalFamily family : {FractalFamily::Mandelbrot, FractalFamily::Julia}) {
+            for (int power = minFractalPower; power <= maxFractalPower && !found; power++) {
+                formula.family = family;
+                formula.power = power;
+                found = fractalFormulaName(formula) == formulaName;
+            }
+            if (found) break;
+        }
+        if (!found) {
+            std::cerr << "Unknown formula: " << formulaName << '\n';
+            return -1;
+        }
+        preprocessor.addSource("fractal_formula.glsl", fractalFormulaSource(formula));
+    }
+    preprocessor.addDirectory(positional[0]);
+
+    std::string source;
+    if (!preprocessor.process(positional[2], defines, source)) return -1;
+
+    std::ofstream file(positional[1], std::ios::binary);
+    file << source;
+    if (!file) {
+        std::cerr << "Failed to write " << positional[1] << '\n';
+        return -1;
+    }
+    return 0;
+}
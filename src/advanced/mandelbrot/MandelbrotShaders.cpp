@@ -0,0 +1,56 @@
+#include "MandelbrotShaders.hpp"
+
+#include <utility>
+
+// The shader files as they were at build time, see embed_shaders
+#include "MandelbrotShaderFiles.hpp"
+
+namespace {
+    const std::pair<const char*, const unsigned char*> embeddedShaders[] = {
+        {"deep_zoom.frag", deepZoomFrag},
+        {"fractal.frag", fractalFrag},
+        {"interior_checks.glsl", interiorChecksGlsl},
+        {"keyframe_resample.frag", keyframeResampleFrag},
+        {"mandelbrot.comp", mandelbrotComp},
+        {"mandelbrot.frag", mandelbrotFrag},
+        {"mandelbrot.vert", mandelbrotVert},
+        {"mandelbrot_coloring.glsl", mandelbrotColoringGlsl},
+        {"progressive_display.frag", progressiveDisplayFrag},
+        {"progressive_iterate.frag", progressiveIterateFrag},
+        {"progressive_shift.frag", progressiveShiftFrag},
+    };
+
+    std::string shaderDirectory;
+}
+
+void setMandelbrotShaderDirectory(const std::string& directory) { shaderDirectory = directory; }
+
+const std::string& mandelbrotShaderDirectory() { return shaderDirectory; }
+
+bool watchMandelbrotShaders(FileWatcher& watcher) {
+    if (shaderDirectory.empty()) return false;
+    bool watching = false;
+    for (const auto& shader : embeddedShaders) {
+        watching = watcher.watch(shaderDirectory + '/' + shader.first) || watching;
+    }
+    return watching;
+}
+
+void addMandelbrotShaders(ShaderPreprocessor& preprocessor) {
+    // Added sources come before directories, so it is one or the other
+    if (!shaderDirectory.empty()) {
+        preprocessor.addDirectory(shaderDirectory);
+        return;
+    }
+    for (const auto& shader : embeddedShaders) {
+        preprocessor.addSource(shader.first, reinterpret_cast<const char*>(shader.second));
+    }
+}
+
+std::string mandelbrotShaderSource(const std::string& name) {
+    ShaderPreprocessor preprocessor;
+    addMandelbrotShaders(preprocessor);
+    std::string source;
+    if (!preprocessor.process(name, {}, source)) source.clear();
+    return source;
+}
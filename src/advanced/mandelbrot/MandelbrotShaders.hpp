@@ -0,0 +1,25 @@
+#pragma once
+
+#include <FileWatcher.hpp>
+#include <ShaderPreprocessor.hpp>
+#include <string>
+
+// The Mandelbrot shader files of resources/shaders, compiled into the program at build time (embed_shaders), so the
+// programs need neither the sources nor a working directory. mandelbrot_coloring.glsl has vec4 mandelbrotColor(int i,
+// int maxIterations, float paletteLength, vec2 z, vec2 c) with z = z_i (the first point outside the escape radius)
+// and the palette on mandelbrotPaletteUnit. It goes right after the #version line (and the FRACTAL_* defines of a
+// formula shader). A negative paletteLength gives the raw count in the red channel instead of a color.
+// interior_checks.glsl has the cardioid/bulb test of the CPU kernels.
+
+// For development: the shader files are read from this directory instead of the embedded ones, edits show up without
+// building again. "" (the default) uses the embedded files. Applies to the programs created afterwards.
+void setMandelbrotShaderDirectory(const std::string& directory);
+const std::string& mandelbrotShaderDirectory();
+
+// Watches the shader files of the directory for edits, false without a directory or if it can't be watched
+bool watchMandelbrotShaders(FileWatcher& watcher);
+
+// Makes the Mandelbrot shader files available to the preprocessor, by file name
+void addMandelbrotShaders(ShaderPreprocessor& preprocessor);
+// Source of a Mandelbrot shader file with its includes expanded, "" (and the reason to std::cerr) if it can't be read
+std::string mandelbrotShaderSource(const std::string& name);
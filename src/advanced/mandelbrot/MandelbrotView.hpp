@@ -0,0 +1,50 @@
+#pragma once
+#include <glad/glad.h>
+
+// Uniform buffer binding point of the View block
+constexpr GLuint mandelbrotViewBinding = 0;
+// Texture unit of the palette (sampler1D u_palette), see PaletteTextures
+constexpr GLint mandelbrotPaletteUnit = 1;
+// Largest u_supersamples, a pixel near the boundary costs up to its square in iterations
+constexpr int maxSupersamples = 8;
+
+// Mirror of the std140 View block that all Mandelbrot fragment shaders share:
+//
+//     layout(std140) uniform View {
+//         vec2 u_resolution;
+//         vec2 u_center;
+//         float u_scale;
+//         int u_maxIterations;
+//         vec2 u_centerLow;
+//         bool u_interiorChecks;
+//         float u_paletteLength;
+//         int u_supersamples;
+//         float u_supersampleThreshold;
+//     };
+//
+// u_centerLow is what float(center) rounded off, the extended precisions use u_center + u_centerLow. Programs may
+// leave out the members after the last one they use. u_interiorChecks turns on the cardioid/bulb test and the cycle
+// detection (see MandelbrotParams::interiorChecks). u_paletteLength is the number of iterations one pass through the
+// palette takes, 0 keeps the plain gray float(i) / float(u_maxIterations) and a negative value writes the raw count
+// (for float render targets, see IterationBudget). The last two only matter to the distance estimation programs (see
+// MandelbrotPrograms): pixels within u_supersampleThreshold pixels of the boundary get u_supersamples^2 samples.
+struct MandelbrotViewBlock {
+    float resolution[2];
+    float center[2];
+    float scale;
+    int maxIterations;
+    float centerLow[2];
+    int interiorChecks;  // std140 bool
+    float paletteLength;
+    int supersamples;
+    float supersampleThreshold;
+
+    // Splits each coordinate into the closest float and the float of what is left
+    void setCenter(double x, double y) {
+        center[0] = static_cast<float>(x);
+        center[1] = static_cast<float>(y);
+        centerLow[0] = static_cast<float>(x - center[0]);
+        centerLow[1] = static_cast<float>(y - center[1]);
+    }
+};
+static_assert(sizeof(MandelbrotViewBlock) == 48, "MandelbrotViewBlock has to match the std140 layout");
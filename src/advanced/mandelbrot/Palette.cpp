@@ -0,0 +1,153 @@
+#include "Palette.hpp"
+
+#include <cmath>
+
+#include "MandelbrotView.hpp"
+
+namespace {
+    struct ColorStop {
+        float position;  // [0, 1), the palette wraps from the last stop to the first
+        uint8_t r, g, b;
+    };
+
+    Palette makePalette(const std::string& name, const std::vector<ColorStop>& stops) {
+        Palette palette{name, std::vector<uint8_t>(paletteSize * 4)};
+        for (int i = 0; i < paletteSize; i++) {
+            float position = (static_cast<float>(i) + 0.5f) / paletteSize;
+
+            // Stops around the position, wrapping at the ends
+            std::size_t next = 0;
+            while (next < stops.size() && stops[next].position <= position) next++;
+            const ColorStop& from = stops[(next + stops.size() - 1) % stops.size()];
+            const ColorStop& to = stops[next % stops.size()];
+            float span = to.position - from.position;
+            if (span <= 0.0f) span += 1.0f;
+            float offset = position - from.position;
+            if (offset < 0.0f) offset += 1.0f;
+            float t = offset / span;
+
+            uint8_t* texel = &palette.texels[i * 4];
+            texel[0] = static_cast<uint8_t>(std::lround(from.r + (to.r - from.r) * t));
+            texel[1] = static_cast<uint8_t>(std::lround(from.g + (to.g - from.g) * t));
+            texel[2] = static_cast<uint8_t>(std::lround(from.b + (to.b - from.b) * t));
+            texel[3] = 255;
+        }
+        return palette;
+    }
+}
+
+const std::vector<Palette>& builtinPalettes() {
+    static const std::vector<Palette> palettes = {
+        // The Ultra Fractal default gradient
+        makePalette("classic", {{0.0f, 0, 7, 100},
+                                {0.16f, 32, 107, 203},
+                                {0.42f, 237, 255, 255},
+                                {0.6425f, 255, 170, 0},
+                                {0.8575f, 0, 2, 0}}),
+        makePalette("fire", {{0.0f, 0, 0, 0}, {0.3f, 180, 20, 0}, {0.55f, 255, 140, 0}, {0.75f, 255, 240, 120}}),
+        makePalette("ocean", {{0.0f, 2, 12, 40}, {0.35f, 0, 110, 140}, {0.6f, 170, 240, 230}, {0.8f, 20, 60, 110}}),
+        makePalette("gray", {{0.0f, 0, 0, 0}, {0.5f, 255, 255, 255}}),
+    };
+    return palettes;
+}
+
+int findPalette(const std::string& name) {
+    const std::vector<Palette>& palettes = builtinPalettes();
+    for (std::size_t i = 0; i < palettes.size(); i++) {
+        if (palettes[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+float smoothIterationCount(uint32_t iterations, float zx, float zy, float cx, float cy, int power) {
+    const float limit = static_cast<float>(std::pow(10.0, smoothEscapeExponent(power)));
+    int n = static_cast<int>(iterations);
+    for (int k = 0; k < smoothExtraIterations && zx * zx + zy * zy < limit; k++) {
+        fractalStep(power, zx, zy, cx, cy);
+        n++;
+    }
+    return static_cast<float>(n) + 1.0f - std::log2(0.5f * std::log2(zx * zx + zy * zy)) * smoothPowerFactor(power);
+}
+
+// Linear filtering with GL_REPEAT, texel centers at (i + 0.5) / paletteSize
+std::array<uint8_t, 3> samplePalette(const Palette& palette, float position) {
+    float u = (position - std::floor(position)) * paletteSize - 0.5f;
+    float base = std::floor(u);
+    float t = u - base;
+    int first = (static_cast<int>(base) + paletteSize) % paletteSize;
+    int second = (first + 1) % paletteSize;
+
+    std::array<uint8_t, 3> color;
+    for (int channel = 0; channel < 3; channel++) {
+        float a = palette.texels[first * 4 + channel];
+        float b = palette.texels[second * 4 + channel];
+        color[channel] = static_cast<uint8_t>(std::lround(a + (b - a) * t));
+    }
+    return color;
+}
+
+std::vector<uint8_t> colorizeMandelbrot(const MandelbrotParams& params,
+                                        const std::vector<uint32_t>& iterations,
+                                        const std::vector<float>& escapeZ,
+                                        const Palette& palette,
+                                        float paletteLength) {
+    std::vector<uint8_t> rgb(static_cast<std::size_t>(params.width) * params.height * 3);
+    const float halfWidth = static_cast<float>(params.width) / 2.0f;
+    const float halfHeight = static_cast<float>(params.height) / 2.0f;
+
+    const FractalFormula& formula = params.formula;
+    const bool julia = formula.family == FractalFamily::Julia;
+
+    uint8_t* out = rgb.data();
+    for (int y = params.height - 1; y >= 0; y--) {  // top row first, gl_FragCoord starts at the bottom
+        const float pixelY = (static_cast<float>(y) + 0.5f - halfHeight) * params.scale + params.centerY;
+        const float cy = julia ? formula.juliaY : pixelY;
+        for (int x = 0; x < params.width; x++, out += 3) {
+            const std::size_t index = static_cast<std::size_t>(y) * params.width + x;
+            const uint32_t count = iterations[index];
+            if (paletteLength <= 0.0f) {
+                float gray = static_cast<float>(count) / static_cast<float>(params.maxIterations);
+                out[0] = out[1] = out[2] = static_cast<uint8_t>(std::lround(gray * 255.0f));
+                continue;
+            }
+            if (count >= static_cast<uint32_t>(params.maxIterations)) {
+                out[0] = out[1] = out[2] = 0;
+                continue;
+            }
+            const float pixelX = (static_cast<float>(x) + 0.5f - halfWidth) * params.scale + params.centerX;
+            const float cx = julia ? formula.juliaX : pixelX;
+            float mu = smoothIterationCount(count, escapeZ[2 * index], escapeZ[2 * index + 1], cx, cy, formula.power);
+            std::array<uint8_t, 3> color = samplePalette(palette, mu / paletteLength);
+            out[0] = color[0];
+            out[1] = color[1];
+            out[2] = color[2];
+        }
+    }
+    return rgb;
+}
+
+PaletteTextures::~PaletteTextures() {
+    for (GLuint texture : textures_) {
+        if (texture) glDeleteTextures(1, &texture);
+    }
+}
+
+void PaletteTextures::bind(int index) {
+    if (textures_.empty()) textures_.assign(builtinPalettes().size(), 0);
+
+    glActiveTexture(GL_TEXTURE0 + mandelbrotPaletteUnit);
+    GLuint& texture = textures_[index];
+    if (!texture) {
+        const Palette& palette = builtinPalettes()[index];
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_1D, texture);
+        glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA8, paletteSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, palette.texels.data());
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        uploads_++;
+    } else {
+        glBindTexture(GL_TEXTURE_1D, texture);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CpuMandelbrot.hpp"
+
+// Smooth (normalized iteration count) coloring. An escaped pixel gets a few extra iterations so |z| is large, then
+// mu = n + 1 - log2(log2 |z_n|) is continuous across the iteration bands. mu / paletteLength wraps around a color
+// lookup table that the GPU samples as a 1D texture and the CPU through samplePalette. Points that never escape are
+// black.
+
+// Entries of every palette
+constexpr int paletteSize = 256;
+// Iterations after the escape, enough to make the log2(log2) term smooth with the escape radius of 2
+constexpr int smoothExtraIterations = 4;
+
+struct Palette {
+    std::string name;
+    std::vector<uint8_t> texels;  // paletteSize RGBA8 entries
+};
+
+const std::vector<Palette>& builtinPalettes();
+// Index into builtinPalettes, -1 if there is none with that name
+int findPalette(const std::string& name);
+
+// CPU versions of the shader functions, same operations in the same order. power is the one of the formula, see
+// smoothPowerFactor.
+float smoothIterationCount(uint32_t iterations, float zx, float zy, float cx, float cy, int power = 2);
+std::array<uint8_t, 3> samplePalette(const Palette& palette, float position);
+
+// RGB image (top row first) of a CPU render of any params.formula, escapeZ as filled by renderMandelbrotCpu
+std::vector<uint8_t> colorizeMandelbrot(const MandelbrotParams& params,
+                                        const std::vector<uint32_t>& iterations,
+                                        const std::vector<float>& escapeZ,
+                                        const Palette& palette,
+                                        float paletteLength);
+
+// GPU copies of the builtin palettes, created on first use and kept. Switching palettes is a texture bind.
+class PaletteTextures {
+    public:
+        PaletteTextures() = default;
+        ~PaletteTextures();
+        PaletteTextures(const PaletteTextures&) = delete;
+        PaletteTextures& operator=(const PaletteTextures&) = delete;
+
+        // Binds the palette to mandelbrotPaletteUnit (the active texture unit stays GL_TEXTURE0)
+        void bind(int index);
+
+        std::size_t uploads() const { return uploads_; }
+
+    private:
+        std::vector<GLuint> textures_;
+        std::size_t uploads_ = 0;
+};
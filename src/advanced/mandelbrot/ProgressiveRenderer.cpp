@@ -0,0 +1,215 @@
+#include "ProgressiveRenderer.hpp"
+
+#include <ShaderUtils.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "MandelbrotShaders.hpp"
+#include "MandelbrotView.hpp"
+
+ProgressiveRenderer::ProgressiveRenderer() {
+    std::string vertexSource = mandelbrotShaderSource("mandelbrot.vert");
+
+    // All three read the state texture from unit 0
+    auto bindState = [](GLuint program) {
+        GLuint viewIndex = glGetUniformBlockIndex(program, "View");
+        if (viewIndex != GL_INVALID_INDEX) glUniformBlockBinding(program, viewIndex, mandelbrotViewBinding);
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "u_state"), 0);
+    };
+
+    auto setupIterate = [this, bindState](GLuint program) {
+        bindState(program);
+        glUseProgram(0);
+        iterateUniforms_ = std::make_unique<UniformBinding>(program);
+        iterationsLocation_ = iterateUniforms_->location("u_iterations");
+    };
+    std::string iterateSource = mandelbrotShaderSource("progressive_iterate.frag");
+    iterateProgram_ =
+        buildShaderProgram(vertexSource.c_str(), iterateSource.c_str(), setupIterate, "progressive_iterate.frag");
+    std::string displaySource = mandelbrotShaderSource("progressive_display.frag");
+    displayProgram_ = buildShaderProgram(vertexSource.c_str(), displaySource.c_str(), [bindState](GLuint program) {
+        bindState(program);
+        glUniform1i(glGetUniformLocation(program, "u_palette"), mandelbrotPaletteUnit);
+        glUseProgram(0);
+    }, "progressive_display.frag");
+    auto setupShift = [this, bindState](GLuint program) {
+        bindState(program);
+        glUseProgram(0);
+        shiftUniforms_ = std::make_unique<UniformBinding>(program);
+        offsetLocation_ = shiftUniforms_->location("u_offset");
+    };
+    std::string shiftSource = mandelbrotShaderSource("progressive_shift.frag");
+    shiftProgram_ = buildShaderProgram(vertexSource.c_str(), shiftSource.c_str(), setupShift, "progressive_shift.frag");
+
+    glGenQueries(1, &timerQuery_);
+}
+
+bool ProgressiveRenderer::ready() const {
+    return shaderProgramReady(iterateProgram_) && shaderProgramReady(displayProgram_) &&
+           shaderProgramReady(shiftProgram_);
+}
+
+bool ProgressiveRenderer::failed() const {
+    return shaderProgramFailed(iterateProgram_) || shaderProgramFailed(displayProgram_) ||
+           shaderProgramFailed(shiftProgram_);
+}
+
+ProgressiveRenderer::~ProgressiveRenderer() {
+    deleteStateTextures();
+    glDeleteQueries(1, &timerQuery_);
+    glDeleteProgram(iterateProgram_);
+    glDeleteProgram(displayProgram_);
+    glDeleteProgram(shiftProgram_);
+}
+
+void ProgressiveRenderer::reset(int width, int height) {
+    GLint previousDrawFramebuffer, previousReadFramebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDrawFramebuffer);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+    if (width != width_ || height != height_) createStateTextures(width, height);
+
+    // z = 0, no iterations, not finished
+    const float zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers_[current_]);
+    glClearBufferfv(GL_COLOR, 0, zero);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDrawFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+
+    completedIterations_ = 0;
+    passes_ = 0;
+    finished_ = false;
+    pendingRegions_.clear();
+}
+
+void ProgressiveRenderer::shift(const FullScreenQuad& quad, int dx, int dy) {
+    if (std::abs(dx) >= width_ || std::abs(dy) >= height_) {
+        reset(width_, height_);
+        return;
+    }
+
+    GLint targetFramebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+
+    // state[next](p) = state[current](p + (dx, dy))
+    const int next = 1 - current_;
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers_[next]);
+    glUseProgram(shiftProgram_);
+    shiftUniforms_->set(offsetLocation_, dx, dy);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, stateTextures_[current_]);
+    quad.draw();
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFramebuffer);
+    current_ = next;
+
+    // A finished state only needs the exposed strips, anything else keeps iterating everywhere
+    pendingRegions_.clear();
+    if (finished_) {
+        if (dx != 0) pendingRegions_.push_back({dx > 0 ? width_ - dx : 0, 0, std::abs(dx), height_});
+        if (dy != 0) pendingRegions_.push_back({0, dy > 0 ? height_ - dy : 0, width_, std::abs(dy)});
+    }
+
+    // The exposed pixels start at 0 iterations, everything else is at least that far
+    completedIterations_ = 0;
+    finished_ = false;
+    shifts_++;
+    reusedPixels_ += static_cast<std::size_t>(width_ - std::abs(dx)) * (height_ - std::abs(dy));
+}
+
+void ProgressiveRenderer::renderFrame(const FullScreenQuad& quad, int maxIterations) {
+    GLint targetFramebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+    glActiveTexture(GL_TEXTURE0);
+
+    if (!finished_) {
+        adaptIterationsPerPass();
+
+        // Iteration pass: state[current] -> state[next]
+        const int next = 1 - current_;
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers_[next]);
+        glUseProgram(iterateProgram_);
+        iterateUniforms_->set(iterationsLocation_, iterationsPerPass_);
+        glBindTexture(GL_TEXTURE_2D, stateTextures_[current_]);
+
+        const bool measure = !queryPending_;
+        if (measure) glBeginQuery(GL_TIME_ELAPSED, timerQuery_);
+        if (pendingRegions_.empty()) {
+            quad.draw();
+        } else {
+            // Everything outside the regions is finished and only has to be carried over
+            GLint previousReadFramebuffer;
+            glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers_[current_]);
+            glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+            glEnable(GL_SCISSOR_TEST);
+            for (const auto& region : pendingRegions_) {
+                glScissor(region[0], region[1], region[2], region[3]);
+                quad.draw();
+            }
+            glDisable(GL_SCISSOR_TEST);
+        }
+        if (measure) {
+            glEndQuery(GL_TIME_ELAPSED);
+            queryPending_ = true;
+        }
+
+        current_ = next;
+        passes_++;
+        completedIterations_ += iterationsPerPass_;
+        finished_ = completedIterations_ >= maxIterations;
+    }
+
+    // Display pass
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFramebuffer);
+    glUseProgram(displayProgram_);
+    glBindTexture(GL_TEXTURE_2D, stateTextures_[current_]);
+    quad.draw();
+}
+
+void ProgressiveRenderer::createStateTextures(int width, int height) {
+    deleteStateTextures();
+    width_ = width;
+    height_ = height;
+
+    glGenTextures(2, stateTextures_);
+    glGenFramebuffers(2, framebuffers_);
+    for (int i = 0; i < 2; i++) {
+        glBindTexture(GL_TEXTURE_2D, stateTextures_[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, stateTextures_[i], 0);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    current_ = 0;
+}
+
+void ProgressiveRenderer::deleteStateTextures() {
+    glDeleteFramebuffers(2, framebuffers_);
+    glDeleteTextures(2, stateTextures_);
+    framebuffers_[0] = framebuffers_[1] = 0;
+    stateTextures_[0] = stateTextures_[1] = 0;
+}
+
+void ProgressiveRenderer::adaptIterationsPerPass() {
+    // Only look at finished queries, waiting for the GPU would defeat the purpose
+    if (!queryPending_) return;
+    GLint available = 0;
+    glGetQueryObjectiv(timerQuery_, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(timerQuery_, GL_QUERY_RESULT, &nanoseconds);
+    queryPending_ = false;
+    if (nanoseconds == 0) return;
+
+    // Scale towards the budget, but at most by a factor of 2 per frame so a single outlier can't blow it
+    double ratio = frameBudgetMilliseconds_ * 1e6 / static_cast<double>(nanoseconds);
+    ratio = std::min(2.0, std::max(0.5, ratio));
+    iterationsPerPass_ = std::max(8, static_cast<int>(iterationsPerPass_ * ratio));
+}
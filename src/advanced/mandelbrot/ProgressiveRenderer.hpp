@@ -0,0 +1,78 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <UniformBinding.hpp>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "FullScreenQuad.hpp"
+
+// Spreads the iterations of a frame over several frames. The iteration state of every pixel (z, iteration count,
+// finished flag) lives in a float texture, each pass continues from where the previous one stopped. The number of
+// iterations per pass follows the measured GPU time, so frames stay within the budget at any zoom level.
+// Uses the View uniform block like the other Mandelbrot programs.
+class ProgressiveRenderer {
+    public:
+        ProgressiveRenderer();
+        ~ProgressiveRenderer();
+        ProgressiveRenderer(const ProgressiveRenderer&) = delete;
+        ProgressiveRenderer& operator=(const ProgressiveRenderer&) = delete;
+
+        // The programs are built through the active ShaderBuildQueue, nothing else works before they are linked
+        bool ready() const;
+        // One of them has errors
+        bool failed() const;
+
+        // Throws away the state (the view changed), resizes the state textures if needed
+        void reset(int width, int height);
+
+        // The view moved by whole pixels (center += (dx, dy) * scale). Shifts the state along, only the newly exposed
+        // strips start over. Call it after the View block got the new center.
+        void shift(const FullScreenQuad& quad, int dx, int dy);
+
+        // Runs one iteration pass and draws the current state into the bound framebuffer
+        void renderFrame(const FullScreenQuad& quad, int maxIterations);
+
+        // Every pixel escaped or reached maxIterations, more passes wouldn't change anything
+        bool finished() const { return finished_; }
+
+        void setFrameBudget(double milliseconds) { frameBudgetMilliseconds_ = milliseconds; }
+        int iterationsPerPass() const { return iterationsPerPass_; }
+        int passes() const { return passes_; }
+        std::size_t shifts() const { return shifts_; }
+        std::size_t reusedPixels() const { return reusedPixels_; }
+
+    private:
+        void createStateTextures(int width, int height);
+        void deleteStateTextures();
+        void adaptIterationsPerPass();
+
+        GLuint iterateProgram_ = 0;
+        GLuint displayProgram_ = 0;
+        GLuint shiftProgram_ = 0;
+        std::unique_ptr<UniformBinding> iterateUniforms_;
+        GLint iterationsLocation_ = -1;
+        std::unique_ptr<UniformBinding> shiftUniforms_;
+        GLint offsetLocation_ = -1;
+
+        // Ping-pong pair: one is read while the other is written
+        GLuint stateTextures_[2] = {0, 0};
+        GLuint framebuffers_[2] = {0, 0};
+        int current_ = 0;
+        int width_ = 0;
+        int height_ = 0;
+
+        GLuint timerQuery_ = 0;
+        bool queryPending_ = false;
+        double frameBudgetMilliseconds_ = 12.0;
+        int iterationsPerPass_ = 64;
+        int completedIterations_ = 0;
+        int passes_ = 0;
+        bool finished_ = false;
+
+        // Rectangles (x, y, width, height) that still need iterations, empty = the whole state
+        std::vector<std::array<int, 4>> pendingRegions_;
+        std::size_t shifts_ = 0;
+        std::size_t reusedPixels_ = 0;
+};
@@ -0,0 +1,36 @@
+#include "ReferenceOrbit.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+int requiredPrecisionBits(double scale) {
+    // Bits down to the pixel size plus enough headroom to place the reference well inside the pixel. Clamped, a scale
+    // of 0 or infinity would make the conversion to int undefined.
+    scale = std::clamp(scale, minimumDeepZoomScale, 1.0);
+    return std::max(64, static_cast<int>(std::ceil(-std::log2(scale))) + 64);
+}
+
+ReferenceOrbit computeReferenceOrbit(const BigFloat& centerX, const BigFloat& centerY, int maxIterations) {
+    ReferenceOrbit orbit{centerX, centerY, {}};
+    orbit.points.reserve(2 * (static_cast<std::size_t>(maxIterations) + 1));
+
+    BigFloat zx(0.0, centerX.precisionBits());
+    BigFloat zy(0.0, centerX.precisionBits());
+    orbit.points.push_back(0.0);
+    orbit.points.push_back(0.0);
+
+    for (int i = 0; i < maxIterations; i++) {
+        BigFloat xx = zx * zx;
+        BigFloat yy = zy * zy;
+        BigFloat xy = zx * zy;
+        zx = xx - yy + centerX;
+        zy = xy + xy + centerY;
+
+        double x = zx.toDouble();
+        double y = zy.toDouble();
+        orbit.points.push_back(x);
+        orbit.points.push_back(y);
+        if (x * x + y * y > 4.0) break;
+    }
+    return orbit;
+}
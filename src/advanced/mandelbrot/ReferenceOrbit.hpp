@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "BigFloat.hpp"
+
+// High precision orbit Z_0 = 0, Z_n+1 = Z_n^2 + C of a single reference point. Each pixel then only iterates its
+// small difference to this orbit (perturbation), which fits into a float no matter how deep the zoom is.
+struct ReferenceOrbit {
+    BigFloat centerX;
+    BigFloat centerY;
+    std::vector<double> points;  // interleaved x, y of Z_0 ... Z_n, rounded to double
+
+    std::size_t length() const { return points.size() / 2; }
+};
+
+// Smallest pixel size of the deep zoom. The offsets to the reference point are doubles of about that size, further
+// down they would lose precision as denormals and finally become 0.
+constexpr double minimumDeepZoomScale = 1e-300;
+
+// Fraction bits the reference point needs, so that it can still be placed exactly inside a pixel of the given size
+// (clamped to minimumDeepZoomScale)
+int requiredPrecisionBits(double scale);
+
+// Iterates the reference point until it escapes (|Z| > 2) or maxIterations is reached. The escaping point is stored.
+ReferenceOrbit computeReferenceOrbit(const BigFloat& centerX, const BigFloat& centerY, int maxIterations);
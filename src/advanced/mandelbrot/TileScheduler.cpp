@@ -0,0 +1,161 @@
+#include "TileScheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <string>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+}
+
+double TileSchedulerStats::efficiency() const {
+    if (workerBusySeconds.empty() || wallSeconds <= 0.0) return 0.0;
+    double busy = 0.0;
+    for (double seconds : workerBusySeconds) busy += seconds;
+    return busy / (wallSeconds * workerBusySeconds.size());
+}
+
+void TileSchedulerStats::print(std::ostream& out) const {
+    out << "Tiles: " << tileMicroseconds.size() << ", workers: " << workerBusySeconds.size()
+        << ", wall: " << wallSeconds * 1000.0 << " ms, efficiency: " << efficiency() * 100.0 << " %\n";
+
+    // Bucket b holds tiles that took [2^b, 2^(b+1)) microseconds
+    std::vector<std::size_t> buckets;
+    for (double microseconds : tileMicroseconds) {
+        std::size_t bucket = microseconds < 1.0 ? 0 : static_cast<std::size_t>(std::log2(microseconds));
+        if (bucket >= buckets.size()) buckets.resize(bucket + 1, 0);
+        buckets[bucket]++;
+    }
+    const std::size_t largest = buckets.empty() ? 1 : *std::max_element(buckets.begin(), buckets.end());
+
+    out << "Tile cost histogram (us):\n";
+    for (std::size_t bucket = 0; bucket < buckets.size(); bucket++) {
+        out << std::setw(10) << (1ull << bucket) << " - " << std::setw(10) << (2ull << bucket) << ": " << std::setw(6)
+            << buckets[bucket] << ' ' << std::string(buckets[bucket] * 50 / largest, '#') << '\n';
+    }
+
+    out << "Worker     tiles  steals   busy ms\n";
+    for (std::size_t worker = 0; worker < workerBusySeconds.size(); worker++) {
+        out << std::setw(6) << worker << std::setw(10) << workerTiles[worker] << std::setw(8) << workerSteals[worker]
+            << std::setw(10) << workerBusySeconds[worker] * 1000.0 << '\n';
+    }
+}
+
+TileScheduler::TileScheduler(int threadCount) {
+    if (threadCount <= 0) threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 0; i < threadCount; i++) queues_.push_back(std::make_unique<WorkerQueue>());
+    for (int i = 1; i < threadCount; i++) threads_.emplace_back(&TileScheduler::workerLoop, this, i);
+}
+
+TileScheduler::~TileScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    startCondition_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+void TileScheduler::run(const std::vector<Tile>& tiles, const std::function<void(const Tile&)>& job) {
+    const std::size_t workers = queues_.size();
+    stats_.tileMicroseconds.assign(tiles.size(), 0.0);
+    stats_.workerBusySeconds.assign(workers, 0.0);
+    stats_.workerTiles.assign(workers, 0);
+    stats_.workerSteals.assign(workers, 0);
+    if (tiles.empty()) return;
+
+    auto start = Clock::now();
+
+    // Contiguous blocks, so neighbouring (similarly expensive) tiles start on the same worker
+    for (std::size_t worker = 0; worker < workers; worker++) {
+        std::lock_guard<std::mutex> lock(queues_[worker]->mutex);
+        for (std::size_t i = worker * tiles.size() / workers; i < (worker + 1) * tiles.size() / workers; i++) {
+            queues_[worker]->tiles.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tiles_ = &tiles;
+        job_ = &job;
+        activeWorkers_ = static_cast<int>(workers) - 1;
+        generation_++;
+    }
+    startCondition_.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this]() { return activeWorkers_ == 0; });
+    stats_.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void TileScheduler::workerLoop(int worker) {
+    uint64_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        startCondition_.wait(lock, [&]() { return stopping_ || generation_ != seenGeneration; });
+        if (stopping_) return;
+        seenGeneration = generation_;
+
+        lock.unlock();
+        work(worker);
+        lock.lock();
+
+        if (--activeWorkers_ == 0) doneCondition_.notify_all();
+    }
+}
+
+void TileScheduler::work(int worker) {
+    std::size_t tile;
+    while (takeLocal(worker, tile) || steal(worker, tile)) {
+        auto start = Clock::now();
+        (*job_)((*tiles_)[tile]);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        // Each tile and each worker slot is only ever written by one thread
+        stats_.tileMicroseconds[tile] = seconds * 1e6;
+        stats_.workerBusySeconds[worker] += seconds;
+        stats_.workerTiles[worker]++;
+    }
+}
+
+bool TileScheduler::takeLocal(int worker, std::size_t& tile) {
+    WorkerQueue& queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tiles.empty()) return false;
+    tile = queue.tiles.front();
+    queue.tiles.pop_front();
+    return true;
+}
+
+bool TileScheduler::steal(int worker, std::size_t& tile) {
+    // Start at a different victim every time, so thieves don't all pile onto the same queue
+    const int workers = static_cast<int>(queues_.size());
+    const int first = static_cast<int>((stats_.workerSteals[worker] * 7 + worker + 1) % workers);
+    for (int i = 0; i < workers; i++) {
+        int victim = (first + i) % workers;
+        if (victim == worker) continue;
+
+        WorkerQueue& queue = *queues_[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tiles.empty()) continue;
+        tile = queue.tiles.back();
+        queue.tiles.pop_back();
+        stats_.workerSteals[worker]++;
+        return true;
+    }
+    return false;
+}
+
+std::vector<Tile> makeTiles(int width, int height, int tileSize) {
+    std::vector<Tile> tiles;
+    for (int y = 0; y < height; y += tileSize) {
+        for (int x = 0; x < width; x += tileSize) {
+            tiles.push_back({x, y, std::min(tileSize, width - x), std::min(tileSize, height - y)});
+        }
+    }
+    return tiles;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "CpuMandelbrot.hpp"
+
+// Timing of the last run, to check how evenly the work was spread
+struct TileSchedulerStats {
+    std::vector<double> tileMicroseconds;  // per tile, same order as the tiles passed to run
+    std::vector<double> workerBusySeconds;
+    std::vector<std::size_t> workerTiles;
+    std::vector<std::size_t> workerSteals;
+    double wallSeconds = 0.0;
+
+    // Busy time of all workers divided by wall time * workers (1.0 = nobody waited)
+    double efficiency() const;
+    // Tile cost histogram with power of two buckets, plus the per worker numbers
+    void print(std::ostream& out) const;
+};
+
+// Persistent thread pool that runs one job per tile. Every worker starts with a contiguous block of tiles in its own
+// deque and takes from the front; once that runs dry it steals from the back of the other deques. Escape-time costs
+// differ by orders of magnitude between tiles, so a static split would leave most threads idle.
+class TileScheduler {
+    public:
+        explicit TileScheduler(int threadCount = 0);  // 0 = one per core
+        ~TileScheduler();
+        TileScheduler(const TileScheduler&) = delete;
+        TileScheduler& operator=(const TileScheduler&) = delete;
+
+        // Runs job for every tile and returns once all are done. The calling thread works as worker 0.
+        void run(const std::vector<Tile>& tiles, const std::function<void(const Tile&)>& job);
+
+        int threadCount() const { return static_cast<int>(queues_.size()); }
+        const TileSchedulerStats& stats() const { return stats_; }
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<std::size_t> tiles;
+        };
+
+        void workerLoop(int worker);
+        void work(int worker);
+        bool takeLocal(int worker, std::size_t& tile);
+        bool steal(int worker, std::size_t& tile);
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues_;
+        std::vector<std::thread> threads_;
+
+        std::mutex mutex_;
+        std::condition_variable startCondition_;
+        std::condition_variable doneCondition_;
+        uint64_t generation_ = 0;
+        int activeWorkers_ = 0;
+        bool stopping_ = false;
+
+        const std::vector<Tile>* tiles_ = nullptr;
+        const std::function<void(const Tile&)>* job_ = nullptr;
+        TileSchedulerStats stats_;
+};
+
+// Splits the image into tiles of tileSize x tileSize pixels (smaller at the right and top border)
+std::vector<Tile> makeTiles(int width, int height, int tileSize);
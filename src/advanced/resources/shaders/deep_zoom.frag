@@ -0,0 +1,111 @@
+#version 330 core
+#include "mandelbrot_coloring.glsl"
+
+// Perturbation against the reference orbit of DeepZoom
+out vec4 FragColor;
+layout(std140) uniform View {
+    vec2 u_resolution;
+    vec2 u_center;
+    float u_scale;
+    int u_maxIterations;
+    vec2 u_centerLow;
+    bool u_interiorChecks;
+    float u_paletteLength;
+};
+uniform float u_scaleMantissa;  // pixel size = u_scaleMantissa * 2^u_scaleExponent
+uniform int u_scaleExponent;
+uniform vec2 u_referenceOffset; // (center - reference) in pixels
+uniform sampler2D u_orbit;
+uniform int u_orbitLength;
+uniform sampler2D u_bla;
+uniform int u_blaSteps;   // of level 0
+uniform int u_blaLevels;  // 0 = iterate every step
+
+const int orbitTextureWidth = 1024;
+
+// 2^e, flushed to zero below the float range
+float exp2i(int e) { return e < -126 ? 0.0 : exp2(float(e)); }
+
+vec2 cmul(vec2 a, vec2 b) { return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x); }
+
+vec2 orbitAt(int n) { return texelFetch(u_orbit, ivec2(n % orbitTextureWidth, n / orbitTextureWidth), 0).xy; }
+
+// BLA step: mantissas of A and B, then the exponents of A and B and log2 of the radius
+void blaStep(int index, out vec4 coefficients, out vec4 exponents) {
+    ivec2 texel = ivec2(2 * index % orbitTextureWidth, 2 * index / orbitTextureWidth);
+    coefficients = texelFetch(u_bla, texel, 0);
+    exponents = texelFetch(u_bla, texel + ivec2(1, 0), 0);
+}
+
+void main() {
+    // Distance of this pixel to the reference point: dc * 2^u_scaleExponent
+    vec2 dc = (gl_FragCoord.xy - u_resolution / 2.0 + u_referenceOffset) * u_scaleMantissa;
+
+    // Distance of z to the reference orbit, stored as d * 2^e so it never leaves the float range
+    vec2 d = vec2(0.0);
+    int e = u_scaleExponent;
+    int n = 0;
+    int i;
+    vec2 z = vec2(0.0);
+
+    for (i = 0; i < u_maxIterations; i++) {
+        vec2 Z = orbitAt(n);
+        z = Z + d * exp2i(e);
+        if (dot(z, z) > 4.0) break;
+
+        // Rebase onto the start of the orbit once the delta dominates or the reference has escaped
+        if (n == u_orbitLength - 1 || dot(z, z) < dot(d, d) * exp2i(2 * e)) {
+            d = z;
+            e = 0;
+            n = 0;
+            Z = vec2(0.0);
+        }
+
+        // Longest BLA step that starts at n and holds for this delta, the levels are aligned to their length
+        int skip = 0;
+        vec4 coefficients, exponents;
+        if (n > 0 && u_blaLevels > 0) {
+            float m = length(d);
+            float logDelta = m > 0.0 ? log2(m) + float(e) : -1e38;
+            int offset = 0;
+            for (int level = 0; level < u_blaLevels; level++) {
+                int span = 1 << level;
+                int index = (n - 1) >> level;
+                if (((n - 1) & (span - 1)) != 0 || index >= (u_blaSteps >> level)) break;
+                if (i + span > u_maxIterations) break;
+                vec4 levelCoefficients, levelExponents;
+                blaStep(offset + index, levelCoefficients, levelExponents);
+                if (!(logDelta < levelExponents.z)) break;
+                skip = span;
+                coefficients = levelCoefficients;
+                exponents = levelExponents;
+                offset += u_blaSteps >> level;
+            }
+        }
+
+        if (skip > 0) {
+            // delta' = A * delta + B * dc, in the exponent of the larger term
+            int eA = int(exponents.x) + e;
+            int eB = int(exponents.y) + u_scaleExponent;
+            e = max(eA, eB);
+            d = cmul(coefficients.xy, d) * exp2i(eA - e) + cmul(coefficients.zw, dc) * exp2i(eB - e);
+            n += skip;
+            i += skip - 1;  // the loop counts the last one
+        } else {
+            // delta' = 2 * Z * delta + delta^2 + dc
+            d = 2.0 * cmul(Z, d) + cmul(d, d) * exp2i(e) + dc * exp2i(u_scaleExponent - e);
+            n++;
+        }
+
+        // Keep the mantissa around 1 and move the magnitude into the exponent
+        float m = max(abs(d.x), abs(d.y));
+        if (m > 0.0) {
+            int k = int(floor(log2(m)));
+            d *= exp2(float(-k));
+            e += k;
+        }
+    }
+
+    // The pixels are far closer to each other than float resolves, the center stands in for c
+    FragColor = mandelbrotColor(i, u_maxIterations, u_paletteLength, z, u_center);
+}
@@ -0,0 +1,58 @@
+#version 400 core
+#include "fractal_formula.glsl"
+#include "mandelbrot_coloring.glsl"
+
+// The loop of the float mandelbrot.frag with fractalStep (fractal_formula.glsl, generated by FractalPrograms), the
+// interior check is only the cycle detection.
+out vec4 FragColor;
+layout(std140) uniform View {
+    vec2 u_resolution;
+    vec2 u_center;
+    float u_scale;
+    int u_maxIterations;
+    vec2 u_centerLow;
+    bool u_interiorChecks;
+    float u_paletteLength;
+};
+uniform vec2 u_julia;
+
+// Points the cycle detection proved to never escape, as opposed to running out of iterations
+bool provenInterior = false;
+
+int iterate(vec2 fragCoord, out vec2 zOut, out vec2 cOut) {
+    precise vec2 pixel = u_center + (fragCoord - u_resolution / 2.0) * u_scale;
+    #if defined(JULIA)
+    precise vec2 z = pixel;
+    vec2 c = u_julia;
+    #else
+    precise vec2 z = vec2(0.0);
+    vec2 c = pixel;
+    #endif
+    cOut = c;
+
+    vec2 saved = vec2(0.0);
+    int i;
+    for (i = 0; i < u_maxIterations; i++) {
+        precise float magnitude = z.x * z.x + z.y * z.y;
+        if (magnitude > 4.0) break;
+        z = fractalStep(z, c);
+
+        // Brent's cycle detection, z is saved after 1, 2, 4, 8, ... iterations
+        if (u_interiorChecks) {
+            if (z == saved) {
+                provenInterior = true;
+                return u_maxIterations;
+            }
+            if (((i + 1) & i) == 0) saved = z;
+        }
+    }
+    zOut = z;
+    return i;
+}
+
+void main() {
+    vec2 z, c;
+    int i = iterate(gl_FragCoord.xy, z, c);
+    FragColor = mandelbrotColor(i, u_maxIterations, u_paletteLength, z, c);
+    if (u_paletteLength < 0.0) FragColor.g = provenInterior ? 1.0 : 0.0;  // statistics (IterationBudget)
+}
@@ -0,0 +1,11 @@
+// Main cardioid or period-2 bulb, same operations as the CPU kernels. These points never escape.
+bool insideCardioidOrBulb(vec2 c) {
+    precise float yy = c.y * c.y;
+    precise float xq = c.x - 0.25;
+    precise float q = xq * xq + yy;
+    precise float quartic = q * (q + xq);
+    precise float quarterYY = 0.25 * yy;
+    precise float xb = c.x + 1.0;
+    precise float bulb = xb * xb + yy;
+    return quartic <= quarterYY || bulb <= 0.0625;
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+// Frame from the two keyframes around its zoom level (KeyframeZoom)
+out vec4 FragColor;
+uniform vec2 u_resolution;
+uniform float u_outerScale;  // part of the outer keyframe the frame shows, (0.5, 1]
+uniform sampler2D u_outer;
+uniform sampler2D u_inner;
+
+void main() {
+    vec2 p = gl_FragCoord.xy / u_resolution - 0.5;
+    vec2 outerUv = 0.5 + p * u_outerScale;
+    vec2 innerUv = 0.5 + p * (2.0 * u_outerScale);
+
+    // Both are sampled, the mipmap level needs derivatives from uniform control flow
+    vec4 outer = texture(u_outer, outerUv);
+    vec4 inner = texture(u_inner, innerUv);
+    bool insideInner = all(greaterThanEqual(innerUv, vec2(0.0))) && all(lessThanEqual(innerUv, vec2(1.0)));
+    FragColor = insideInner ? inner : outer;
+}
@@ -0,0 +1,220 @@
+#version 400 core
+#include "interior_checks.glsl"
+#include "mandelbrot_coloring.glsl"
+
+// precise keeps the driver from fusing multiply-adds: the single precision variant then rounds like the CPU backend
+// (MandelbrotCpu) and produces the same iteration counts, the df64 variant depends on exact rounding errors.
+out vec4 FragColor;
+layout(std140) uniform View {
+    vec2 u_resolution;
+    vec2 u_center;
+    float u_scale;
+    int u_maxIterations;
+    vec2 u_centerLow;  // center - u_center, only used by the extended precisions
+    bool u_interiorChecks;
+    float u_paletteLength;
+    int u_supersamples;            // per axis, distance estimation only
+    float u_supersampleThreshold;  // in pixels
+};
+
+// Points the checks proved to never escape, as opposed to running out of iterations
+bool provenInterior = false;
+int interiorPoint() {
+    provenInterior = true;
+    return u_maxIterations;
+}
+
+// Brent's cycle detection saves z after 1, 2, 4, 8, ... iterations
+bool saveIteration(int i) { return ((i + 1) & i) == 0; }
+
+#if defined(DISTANCE_ESTIMATION)
+// dz/dc next to z: dz' = 2 z dz + 1. A large escape radius makes the estimate accurate. Once dz is past 1e18
+// the distance is far below any pixel size this shader renders, it stops there instead of overflowing.
+const float escapeRadiusSquared = 65536.0;
+vec2 derivative = vec2(0.0);
+bool derivativeSaturated = false;
+
+void trackDerivative(vec2 z) {
+    if (derivativeSaturated) return;
+    derivative = 2.0 * vec2(z.x * derivative.x - z.y * derivative.y, z.x * derivative.y + z.y * derivative.x);
+    derivative.x += 1.0;
+    if (dot(derivative, derivative) > 1e36) derivativeSaturated = true;
+}
+#else
+const float escapeRadiusSquared = 4.0;
+void trackDerivative(vec2 z) {}
+#endif
+
+#if defined(PRECISION_DOUBLE_FLOAT)
+// df64: a value is hi + lo with |lo| <= ulp(hi) / 2, stored as vec2(hi, lo)
+vec2 twoSum(float a, float b) {
+    precise float s = a + b;
+    precise float v = s - a;
+    precise float e = (a - (s - v)) + (b - v);
+    return vec2(s, e);
+}
+
+vec2 quickTwoSum(float a, float b) {
+    precise float s = a + b;
+    precise float e = b - (s - a);
+    return vec2(s, e);
+}
+
+// Exact a * b as hi + lo (Dekker), fma() isn't guaranteed to be fused everywhere
+vec2 twoProduct(float a, float b) {
+    const float splitter = 4097.0;  // 2^12 + 1
+    precise float p = a * b;
+    precise float ta = splitter * a;
+    precise float aHigh = ta - (ta - a);
+    precise float aLow = a - aHigh;
+    precise float tb = splitter * b;
+    precise float bHigh = tb - (tb - b);
+    precise float bLow = b - bHigh;
+    precise float e = ((aHigh * bHigh - p) + aHigh * bLow + aLow * bHigh) + aLow * bLow;
+    return vec2(p, e);
+}
+
+vec2 dfAdd(vec2 a, vec2 b) {
+    precise vec2 s = twoSum(a.x, b.x);
+    precise vec2 t = twoSum(a.y, b.y);
+    s.y += t.x;
+    s = quickTwoSum(s.x, s.y);
+    s.y += t.y;
+    return quickTwoSum(s.x, s.y);
+}
+
+vec2 dfMul(vec2 a, vec2 b) {
+    precise vec2 p = twoProduct(a.x, b.x);
+    p.y += a.x * b.y + a.y * b.x;
+    return quickTwoSum(p.x, p.y);
+}
+
+int iterate(vec2 fragCoord, out vec2 z, out vec2 c) {
+    vec2 offset = fragCoord - u_resolution / 2.0;  // exact, fractions of a pixel
+    vec2 cx = dfAdd(vec2(u_center.x, u_centerLow.x), twoProduct(offset.x, u_scale));
+    vec2 cy = dfAdd(vec2(u_center.y, u_centerLow.y), twoProduct(offset.y, u_scale));
+    c = vec2(cx.x, cy.x);
+    if (u_interiorChecks && insideCardioidOrBulb(vec2(cx.x, cy.x))) return interiorPoint();
+
+    vec2 zx = vec2(0.0);
+    vec2 zy = vec2(0.0);
+    vec2 savedX = vec2(0.0);
+    vec2 savedY = vec2(0.0);
+    int i;
+
+    for (i = 0; i < u_maxIterations; i++) {
+        vec2 xx = dfMul(zx, zx);
+        vec2 yy = dfMul(zy, zy);
+        if (xx.x + yy.x > escapeRadiusSquared) break;
+        trackDerivative(vec2(zx.x, zy.x));
+        vec2 xy = dfMul(zx, zy);
+        zy = dfAdd(xy + xy, cy);  // doubling is exact
+        zx = dfAdd(dfAdd(xx, -yy), cx);
+
+        if (u_interiorChecks) {
+            if (zx == savedX && zy == savedY) return interiorPoint();
+            if (saveIteration(i)) {
+                savedX = zx;
+                savedY = zy;
+            }
+        }
+    }
+    z = vec2(zx.x, zy.x);
+    return i;
+}
+#elif defined(PRECISION_DOUBLE)
+int iterate(vec2 fragCoord, out vec2 zOut, out vec2 cOut) {
+    dvec2 center = dvec2(u_center) + dvec2(u_centerLow);
+    dvec2 c = center + (dvec2(fragCoord) - dvec2(u_resolution) / 2.0) * double(u_scale);
+    cOut = vec2(c);
+    if (u_interiorChecks && insideCardioidOrBulb(vec2(c))) return interiorPoint();
+
+    dvec2 z = dvec2(0.0);
+    dvec2 saved = dvec2(0.0);
+    int i;
+
+    for (i = 0; i < u_maxIterations; i++) {
+        double magnitude = z.x * z.x + z.y * z.y;
+        if (magnitude > escapeRadiusSquared) break;
+        trackDerivative(vec2(z));
+        z = dvec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+
+        if (u_interiorChecks) {
+            if (z == saved) return interiorPoint();
+            if (saveIteration(i)) saved = z;
+        }
+    }
+    zOut = vec2(z);
+    return i;
+}
+#else
+int iterate(vec2 fragCoord, out vec2 zOut, out vec2 cOut) {
+    precise vec2 c = u_center + (fragCoord - u_resolution / 2.0) * u_scale;
+    cOut = c;
+    if (u_interiorChecks && insideCardioidOrBulb(c)) return interiorPoint();
+
+    precise vec2 z = vec2(0.0);
+    vec2 saved = vec2(0.0);
+    int i;
+
+    for (i = 0; i < u_maxIterations; i++) {
+        precise float magnitude = z.x * z.x + z.y * z.y;  // |z|^2 > 4 instead of length(z) > 2, no sqrt
+        if (magnitude > escapeRadiusSquared) break;
+        trackDerivative(z);
+        z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+
+        // An exact repeat means the orbit is periodic and never escapes
+        if (u_interiorChecks) {
+            if (z == saved) return interiorPoint();
+            if (saveIteration(i)) saved = z;
+        }
+    }
+    zOut = z;
+    return i;
+}
+#endif
+
+#if defined(DISTANCE_ESTIMATION)
+// Exterior color darkened within a pixel of the boundary, which anti-aliases the filaments. boundaryDistance
+// is the estimate 2 |z| log|z| / |dz| (the true distance is between a quarter of it and all of it), -1 inside.
+vec4 distanceColor(vec2 fragCoord, out float boundaryDistance) {
+    vec2 z, c;
+    derivative = vec2(0.0);
+    derivativeSaturated = false;
+    int i = iterate(fragCoord, z, c);
+    if (i >= u_maxIterations) {
+        boundaryDistance = -1.0;
+        return vec4(0.0, 0.0, 0.0, 1.0);
+    }
+
+    float r = length(z);
+    boundaryDistance = derivativeSaturated ? 0.0 : 2.0 * r * log(r) / length(derivative);
+    vec3 color = vec3(1.0);
+    if (u_paletteLength > 0.0) color = mandelbrotColor(i, u_maxIterations, u_paletteLength, z, c).rgb;
+    return vec4(color * clamp(boundaryDistance / u_scale, 0.0, 1.0), 1.0);
+}
+
+void main() {
+    float boundaryDistance;
+    FragColor = distanceColor(gl_FragCoord.xy, boundaryDistance);
+
+    // Only pixels near the boundary get the n x n samples, elsewhere one sample has no bands to alias
+    if (u_supersamples > 1 && boundaryDistance >= 0.0 && boundaryDistance < u_supersampleThreshold * u_scale) {
+        vec4 sum = vec4(0.0);
+        for (int y = 0; y < u_supersamples; y++) {
+            for (int x = 0; x < u_supersamples; x++) {
+                vec2 at = floor(gl_FragCoord.xy) + (vec2(x, y) + 0.5) / float(u_supersamples);
+                sum += distanceColor(at, boundaryDistance);
+            }
+        }
+        FragColor = sum / float(u_supersamples * u_supersamples);
+    }
+}
+#else
+void main() {
+    vec2 z, c;
+    int i = iterate(gl_FragCoord.xy, z, c);
+    FragColor = mandelbrotColor(i, u_maxIterations, u_paletteLength, z, c);
+    if (u_paletteLength < 0.0) FragColor.g = provenInterior ? 1.0 : 0.0;  // statistics (IterationBudget)
+}
+#endif
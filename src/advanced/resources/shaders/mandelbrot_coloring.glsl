@@ -0,0 +1,27 @@
+// vec4 mandelbrotColor(int i, int maxIterations, float paletteLength, vec2 z, vec2 c) with z = z_i (the first point
+// outside the escape radius), see Palette.hpp. Included right after the #version line (and the FRACTAL_* defines of a
+// formula shader).
+uniform sampler1D u_palette;
+
+// z^2 + c, formula shaders (FractalPrograms) define their own step and constants for z^power + c
+#ifndef FRACTAL_STEP
+#define FRACTAL_STEP(z, c) (vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c)
+#define FRACTAL_ESCAPE_LIMIT 1e16
+#define FRACTAL_POWER_FACTOR 1.0
+#endif
+
+// Keep in sync with smoothIterationCount and smoothExtraIterations (Palette.cpp)
+vec4 mandelbrotColor(int i, int maxIterations, float paletteLength, vec2 z, vec2 c) {
+    if (paletteLength < 0.0) return vec4(float(i), 0.0, 0.0, 1.0);  // raw count for IterationBudget
+    if (paletteLength == 0.0) return vec4(vec3(float(i) / float(maxIterations)), 1.0);
+    if (i >= maxIterations) return vec4(0.0, 0.0, 0.0, 1.0);
+
+    // A few more iterations, stopping before |z|^2 could overflow
+    int n = i;
+    for (int k = 0; k < 4 && dot(z, z) < FRACTAL_ESCAPE_LIMIT; k++) {
+        z = FRACTAL_STEP(z, c);
+        n++;
+    }
+    float mu = float(n) + 1.0 - log2(0.5 * log2(dot(z, z))) * FRACTAL_POWER_FACTOR;
+    return vec4(textureLod(u_palette, mu / paletteLength, 0.0).rgb, 1.0);
+}
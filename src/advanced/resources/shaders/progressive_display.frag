@@ -0,0 +1,23 @@
+#version 400 core
+#include "mandelbrot_coloring.glsl"
+
+// Shows the state. Unfinished pixels are shown with their current count in gray and like the interior with a palette.
+out vec4 FragColor;
+layout(std140) uniform View {
+    vec2 u_resolution;
+    vec2 u_center;
+    float u_scale;
+    int u_maxIterations;
+    vec2 u_centerLow;
+    bool u_interiorChecks;
+    float u_paletteLength;
+};
+uniform sampler2D u_state;
+
+void main() {
+    vec4 state = texelFetch(u_state, ivec2(gl_FragCoord.xy), 0);
+    int i = int(state.z);
+    if (state.w == 0.0 && u_paletteLength > 0.0) i = u_maxIterations;
+    vec2 c = u_center + (gl_FragCoord.xy - u_resolution / 2.0) * u_scale;
+    FragColor = mandelbrotColor(i, u_maxIterations, u_paletteLength, state.xy, c);
+}
@@ -0,0 +1,55 @@
+#version 400 core
+#include "interior_checks.glsl"
+
+// One iteration pass, same math as mandelbrot.frag split into chunks: a pixel that stops at the end of a pass does
+// its escape check at the start of the next one.
+layout(location = 0) out vec4 State;  // z.x, z.y, iterations, finished
+layout(std140) uniform View {
+    vec2 u_resolution;
+    vec2 u_center;
+    float u_scale;
+    int u_maxIterations;
+    vec2 u_centerLow;
+    bool u_interiorChecks;
+};
+uniform sampler2D u_state;
+uniform int u_iterations;
+
+void main() {
+    vec4 state = texelFetch(u_state, ivec2(gl_FragCoord.xy), 0);
+    if (state.w != 0.0) {
+        State = state;
+        return;
+    }
+
+    precise vec2 c = u_center + (gl_FragCoord.xy - u_resolution / 2.0) * u_scale;
+    precise vec2 z = state.xy;
+    int i = int(state.z);
+    int start = i;
+    int end = min(i + u_iterations, u_maxIterations);
+    bool escaped = false;
+
+    if (u_interiorChecks && i == 0 && insideCardioidOrBulb(c)) i = u_maxIterations;
+
+    // The cycle detection starts over with every pass, saving z after 1, 2, 4, ... iterations of the pass
+    vec2 saved = z;
+    for (; i < end; i++) {
+        precise float magnitude = z.x * z.x + z.y * z.y;
+        if (magnitude > 4.0) {
+            escaped = true;
+            break;
+        }
+        z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+
+        if (u_interiorChecks) {
+            if (z == saved) {
+                i = u_maxIterations;
+                break;
+            }
+            int done = i + 1 - start;
+            if ((done & (done - 1)) == 0) saved = z;
+        }
+    }
+
+    State = vec4(z, float(i), (escaped || i >= u_maxIterations) ? 1.0 : 0.0);
+}
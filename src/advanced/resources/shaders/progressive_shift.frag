@@ -0,0 +1,12 @@
+#version 400 core
+
+// Moves the state by whole pixels, exposed pixels start from scratch
+layout(location = 0) out vec4 State;
+uniform sampler2D u_state;
+uniform ivec2 u_offset;
+
+void main() {
+    ivec2 source = ivec2(gl_FragCoord.xy) + u_offset;
+    bool inside = all(greaterThanEqual(source, ivec2(0))) && all(lessThan(source, textureSize(u_state, 0)));
+    State = inside ? texelFetch(u_state, source, 0) : vec4(0.0);
+}
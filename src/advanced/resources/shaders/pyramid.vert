@@ -0,0 +1,20 @@
+#version 330 core
+#ifdef GL_SPIRV
+#extension GL_ARB_explicit_uniform_location : require
+#endif
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+out vec3 color;
+#ifdef GL_SPIRV
+// Explicit location only for SPIR-V, a module has no names to look uniforms up by
+layout (location = 0) uniform float scale;
+#else
+uniform float scale;
+#endif
+
+void main()
+{
+   gl_Position = vec4(aPos.x * scale, aPos.y * scale, aPos.z * scale, 1);
+   color = aColor;
+}
@@ -3,10 +3,31 @@
 #include <glad/glad.h>
 
 #include <GLFW/glfw3.h>
+#include <HeadlessContext.hpp>
 #include <iostream>
+#include <memory>
 
-int main()
+// --headless clears a single frame without a window (EGL) and writes it to --output
+int main(int argc, char **argv)
 {
+    HeadlessOptions headless;
+    headless.width = 500;
+    headless.height = 500;
+    headless.output = "create_window.ppm";
+    if (!parseHeadlessOptions(argc, argv, headless)) return -1;
+
+    if (headless.enabled)
+    {
+        HeadlessContext headlessContext(headless.width, headless.height);
+        if (!headlessContext.valid()) return -1;
+
+        glClearColor(0.5f, 0.15f, 0.75f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        if (!headlessContext.writePpm(headless.output)) return -1;
+        std::cout << "Wrote " << headless.output << '\n';
+        return 0;
+    }
+
     // initialize opengl
     glfwInit();
 
@@ -16,7 +37,7 @@ int main()
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // OpenGL version 3.3, modern profile
 
     // Create Window (also check whether we were able to create it properly)
-    GLFWwindow *window = glfwCreateWindow(500, 500, "CreateWindow", nullptr, nullptr);
+    GLFWwindow *window = glfwCreateWindow(headless.width, headless.height, "CreateWindow", nullptr, nullptr);
     if (!window)
     {
         std::cerr << "Unable to create window" << std::endl;
@@ -25,8 +46,8 @@ int main()
     }
     glfwMakeContextCurrent(window); // Add window to context
 
-    gladLoadGL();               // use Glad to load opengl configurations
-    glViewport(0, 0, 500, 500); // set viewport
+    gladLoadGL();                                      // use Glad to load opengl configurations
+    glViewport(0, 0, headless.width, headless.height); // set viewport
 
     glClearColor(0.5f, 0.15f, 0.75f, 1.0f); // clear color of buffer and assign new color
     glClear(GL_COLOR_BUFFER_BIT);           // execute command on the color buffer
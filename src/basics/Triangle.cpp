@@ -1,33 +1,48 @@
 #pragma once
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <HeadlessContext.hpp>
+#include <ShaderBuildQueue.hpp>
+#include <ShaderUtils.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Shader files (resources/shaders), the build points SHADER_DIRECTORY at the directory in the sources
+#ifndef SHADER_DIRECTORY
+#define SHADER_DIRECTORY "resources/shaders"
+#endif
+const char *vertexShaderPath = SHADER_DIRECTORY "/solid.vert";
+const char *fragmentShaderPath = SHADER_DIRECTORY "/solid.frag";
+
+// --headless renders a single frame without a window (EGL) and writes it to --output
+int main(int argc, char **argv) {
+    HeadlessOptions headless;
+    headless.width = 500;
+    headless.height = 500;
+    headless.output = "triangle.ppm";
+    if (!parseHeadlessOptions(argc, argv, headless)) return -1;
+
+    std::string vertexShaderSrc, fragmentShaderSrc;
+    if (!readShaderFile(vertexShaderPath, vertexShaderSrc) || !readShaderFile(fragmentShaderPath, fragmentShaderSrc)) {
+        return -1;
+    }
+
+    GLFWwindow *window = nullptr;
+    std::unique_ptr<HeadlessContext> headlessContext;
+    if (headless.enabled) {
+        headlessContext = std::make_unique<HeadlessContext>(headless.width, headless.height);
+        if (!headlessContext->valid()) return -1;
+    } else {
+        glfwInit();
 
-// Shaders
-const char *vertexShaderSrc =
-    "#version 330 core\n"
-    "layout (location = 0) in vec3 aPos;\n"
-    "void main()\n"
-    "{\n"
-    "   gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1);\n"
-    "}\n\0";
-
-const char *fragmentShaderSrc =
-    "#version 330 core\n"
-    "out vec4 FragColor;\n"
-    "void main()\n"
-    "{\n"
-    "  FragColor = vec4(0.8f, 0.3f, 0.92f, 1.0f);"
-    "}\n\0";
-
-int main() {
-    glfwInit();
-
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow *window(glfwCreateWindow(500, 500, "Triangle", nullptr, nullptr));
-    glfwMakeContextCurrent(window);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        window = glfwCreateWindow(headless.width, headless.height, "Triangle", nullptr, nullptr);
+        glfwMakeContextCurrent(window);
+    }
 
     // Graphics Pipeline:
     //
@@ -41,25 +56,15 @@ int main() {
     //  6. Tests and Blending
     //
 
-    gladLoadGL();
+    if (window) gladLoadGL();  // the headless context has loaded GLAD already
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // set background color of the window
 
-    // Load vertex Shader
-    GLuint vertexShader(glCreateShader(GL_VERTEX_SHADER));
-    glShaderSource(vertexShader, 1, &vertexShaderSrc, nullptr);
-    glCompileShader(vertexShader);
-    // Load fragment Shader
-    GLuint fragmentShader(glCreateShader(GL_FRAGMENT_SHADER));
-    glShaderSource(fragmentShader, 1, &fragmentShaderSrc, nullptr);
-    glCompileShader(fragmentShader);
-    // Create ShaderProgram and link our own shaders
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    // Delete Shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    // Compile and link the shader program without waiting for the driver (see ShaderBuildQueue). The window shows
+    // the background until the program is ready, the headless frame waits for it.
+    ShaderBuildQueue buildQueue;
+    ShaderBuildQueue::setActive(&buildQueue);
+    GLuint shaderProgram = buildShaderProgram(vertexShaderSrc.c_str(), fragmentShaderSrc.c_str(), {});
+    if (!window) buildQueue.finish();
 
     GLuint VAO, VBO;
     glGenVertexArrays(1, &VAO);  // vertex array object -> stores multiple VBO's
@@ -83,24 +88,43 @@ int main() {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    while (!glfwWindowShouldClose(window)) {
+    bool failed = false;
+    while (!window || !glfwWindowShouldClose(window)) {
+        buildQueue.poll();
+        if (shaderProgramFailed(shaderProgram)) {
+            std::cerr << "The shader program failed to build, see the errors above\n";
+            failed = true;
+            break;
+        }
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-        glUseProgram(shaderProgram);
-        glBindVertexArray(0);
+        if (shaderProgramReady(shaderProgram)) {
+            glUseProgram(shaderProgram);
+            glBindVertexArray(VAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindVertexArray(0);
+        }
 
+        if (!window) break;  // headless: one frame is all there is
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    if (headlessContext && !failed) {
+        failed = !headlessContext->writePpm(headless.output);
+        if (!failed) std::cout << "Wrote " << headless.output << '\n';
+    }
+
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    buildQueue.finish();
+    ShaderBuildQueue::setActive(nullptr);
     glDeleteProgram(shaderProgram);
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 
-    return 0;
+    return failed ? -1 : 0;
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 330 core
+out vec4 FragColor;
+void main()
+{
+  FragColor = vec4(0.8f, 0.3f, 0.92f, 1.0f);
+}
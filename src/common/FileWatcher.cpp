@@ -0,0 +1,91 @@
+#include "FileWatcher.hpp"
+
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#ifdef COMMON_HAS_INOTIFY
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <climits>
+
+namespace {
+    // The directory and the name of a path, "." for a bare name
+    std::pair<std::string, std::string> splitPath(const std::string& path) {
+        std::size_t slash = path.find_last_of('/');
+        if (slash == std::string::npos) return {".", path};
+        return {slash == 0 ? "/" : path.substr(0, slash), path.substr(slash + 1)};
+    }
+}
+#endif
+
+FileWatcher::FileWatcher() {
+#ifdef COMMON_HAS_INOTIFY
+    descriptor_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef COMMON_HAS_INOTIFY
+    if (descriptor_ >= 0) close(descriptor_);
+#endif
+}
+
+bool FileWatcher::supported() {
+#ifdef COMMON_HAS_INOTIFY
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool FileWatcher::watch(const std::string& path) {
+#ifdef COMMON_HAS_INOTIFY
+    if (descriptor_ < 0) return false;
+    auto [directory, name] = splitPath(path);
+    int watch = inotify_add_watch(descriptor_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watch < 0) return false;
+    directories_[watch] = directory;
+    paths_[directory + '/' + name] = path;
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+std::vector<std::string> FileWatcher::wait(int timeoutMilliseconds) {
+    std::vector<std::string> changed;
+#ifdef COMMON_HAS_INOTIFY
+    if (descriptor_ < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMilliseconds));
+        return changed;
+    }
+    pollfd request{descriptor_, POLLIN, 0};
+    if (poll(&request, 1, timeoutMilliseconds) <= 0) return changed;
+
+    // Room for a few events with the longest names
+    alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+    ssize_t length;
+    while ((length = read(descriptor_, buffer, sizeof(buffer))) > 0) {
+        for (char* position = buffer; position < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(position);
+            position += sizeof(inotify_event) + event->len;
+            auto directory = directories_.find(event->wd);
+            if (directory == directories_.end() || event->len == 0) continue;
+
+            auto file = paths_.find(directory->second + '/' + event->name);
+            if (file == paths_.end()) continue;
+            const std::string& path = file->second;
+            bool known = false;
+            for (const std::string& other : changed) known = known || other == path;
+            if (!known) changed.push_back(path);
+        }
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMilliseconds));
+#endif
+    return changed;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Tells which of a set of files changed on disk (inotify, Linux). The directories are watched instead of the files:
+// editors save by writing in place, by writing a temporary file and renaming it over the old one, or by deleting and
+// recreating it, and only the directory sees all of those. Without inotify (see supported) nothing is ever reported.
+class FileWatcher {
+    public:
+        FileWatcher();
+        ~FileWatcher();
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        // Whether the build has inotify
+        static bool supported();
+
+        // false if the directory of the file can't be watched
+        bool watch(const std::string& path);
+
+        // Waits up to timeoutMilliseconds for a change, returns the watched paths (as given to watch) that changed
+        std::vector<std::string> wait(int timeoutMilliseconds);
+
+    private:
+        int descriptor_ = -1;
+        std::map<int, std::string> directories_;    // by watch descriptor
+        std::map<std::string, std::string> paths_;  // directory + '/' + name -> as given to watch
+};
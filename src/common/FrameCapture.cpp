@@ -0,0 +1,158 @@
+#include "FrameCapture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+FrameCapture::FrameCapture(std::string prefix, ImageFormat format, int ringSize, int threads)
+    : prefix_(std::move(prefix)), format_(format), slots_(std::max(ringSize, 2)) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    // Enough to ride out an encoder hiccup, bounded so a slow disk can't eat the memory
+    maxQueuedJobs_ = 2 * static_cast<std::size_t>(threads);
+
+    for (Slot& slot : slots_) glGenBuffers(1, &slot.buffer);
+    for (int i = 0; i < threads; i++) workers_.emplace_back(&FrameCapture::workerLoop, this);
+}
+
+FrameCapture::~FrameCapture() {
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    jobAdded_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+    for (Slot& slot : slots_) glDeleteBuffers(1, &slot.buffer);
+}
+
+void FrameCapture::capture(int width, int height) {
+    // Hand over whatever the GPU finished since the last frame, oldest first
+    for (std::size_t i = 0; i < slots_.size(); i++) {
+        Slot& slot = slots_[(nextSlot_ + i) % slots_.size()];
+        if (slot.fence) collect(slot, false);
+    }
+
+    // The ring is full if the oldest readback still isn't done
+    Slot& slot = slots_[nextSlot_];
+    if (slot.fence) collect(slot, true);
+
+    const std::size_t size = static_cast<std::size_t>(width) * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);  // into the buffer, doesn't wait
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.frame = nextFrame_++;
+    nextSlot_ = (nextSlot_ + 1) % slots_.size();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.captured++;
+}
+
+void FrameCapture::finish() {
+    for (std::size_t i = 0; i < slots_.size(); i++) {
+        Slot& slot = slots_[(nextSlot_ + i) % slots_.size()];
+        if (slot.fence) collect(slot, true);
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    jobTaken_.wait(lock, [this] { return jobs_.empty() && busyWorkers_ == 0; });
+}
+
+FrameCaptureStats FrameCapture::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool FrameCapture::collect(Slot& slot, bool wait) {
+    // The flush makes sure the fence reaches the GPU even if nothing else flushes (headless, no swap)
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        if (!wait) return false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.readbackStalls++;
+        }
+        do {
+            status = glClientWaitSync(slot.fence, 0, 1000000000);  // 1 s
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (status == GL_WAIT_FAILED) {
+        std::cerr << "Waiting for the readback of frame " << slot.frame << " failed\n";
+        return false;
+    }
+
+    // Copy out so the buffer can be reused right away, flipped on the way (glReadPixels starts at the bottom)
+    Job job{std::vector<uint8_t>(slot.capacity), slot.width, slot.height, slot.frame};
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    auto* pixels = static_cast<const uint8_t*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(slot.capacity), GL_MAP_READ_BIT));
+    if (pixels) {
+        const std::size_t rowSize = static_cast<std::size_t>(slot.width) * 4;
+        for (int y = 0; y < slot.height; y++) {
+            std::memcpy(job.pixels.data() + y * rowSize, pixels + (slot.height - 1 - y) * rowSize, rowSize);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!pixels) {
+        std::cerr << "Failed to map the readback of frame " << slot.frame << '\n';
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (jobs_.size() >= maxQueuedJobs_) {
+        stats_.encoderStalls++;
+        jobTaken_.wait(lock, [this] { return jobs_.size() < maxQueuedJobs_; });
+    }
+    jobs_.push_back(std::move(job));
+    lock.unlock();
+    jobAdded_.notify_one();
+    return true;
+}
+
+void FrameCapture::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        jobAdded_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (jobs_.empty()) return;  // stopping
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        busyWorkers_++;
+        lock.unlock();
+        jobTaken_.notify_all();
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<uint8_t> file = encodeImage(format_, job.width, job.height, job.pixels.data());
+        std::string path = fileName(job.frame);
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        bool written = static_cast<bool>(out);
+        out.close();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!written) std::cerr << "Failed to write " << path << '\n';
+
+        lock.lock();
+        busyWorkers_--;
+        stats_.written += written;
+        stats_.encodeSeconds += seconds;
+        jobTaken_.notify_all();
+    }
+}
+
+std::string FrameCapture::fileName(std::size_t frame) const {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%06zu", frame);
+    return prefix_ + number + imageFormatExtension(format_);
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ImageEncoders.hpp"
+
+// Statistics of a capture session
+struct FrameCaptureStats {
+    std::size_t captured = 0;       // frames whose readback was started
+    std::size_t written = 0;        // frames encoded and written
+    std::size_t readbackStalls = 0;  // capture had to wait for the GPU (ring too short)
+    std::size_t encoderStalls = 0;   // capture had to wait for the encoders (pool too small)
+    double encodeSeconds = 0.0;      // summed over all workers
+};
+
+// Records frames without stalling the render loop. glReadPixels goes into a ring of pixel buffer objects, so it only
+// queues a copy on the GPU. A fence after each copy tells when the pixels can be mapped, which is normally a couple
+// of frames later. The mapped pixels are copied out and encoded by a pool of worker threads.
+//
+// Frame n is written to prefix + n (six digits) + the extension of the format.
+class FrameCapture {
+    public:
+        // ringSize >= 2 buffers, 3 is enough to hide the readback latency of most drivers. 0 threads = one per core.
+        FrameCapture(std::string prefix, ImageFormat format, int ringSize = 3, int threads = 0);
+        ~FrameCapture();
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        // Starts the readback of the bound read framebuffer (the back buffer for a window) and hands finished earlier
+        // readbacks to the encoders. Call it after rendering, before the buffer swap.
+        void capture(int width, int height);
+
+        // Waits for all readbacks and encoders, every captured frame is on disk afterwards
+        void finish();
+
+        FrameCaptureStats stats() const;
+        std::size_t frames() const { return nextFrame_; }
+
+    private:
+        struct Slot {
+            GLuint buffer = 0;
+            std::size_t capacity = 0;  // bytes
+            GLsync fence = nullptr;    // pending readback
+            int width = 0;
+            int height = 0;
+            std::size_t frame = 0;
+        };
+        struct Job {
+            std::vector<uint8_t> pixels;  // RGBA, top row first
+            int width;
+            int height;
+            std::size_t frame;
+        };
+
+        // Maps a slot whose fence signaled and queues its pixels. wait blocks until the GPU is done.
+        bool collect(Slot& slot, bool wait);
+        void workerLoop();
+        std::string fileName(std::size_t frame) const;
+
+        std::string prefix_;
+        ImageFormat format_;
+        std::vector<Slot> slots_;
+        std::size_t nextSlot_ = 0;
+        std::size_t nextFrame_ = 0;
+        std::size_t maxQueuedJobs_;
+
+        std::vector<std::thread> workers_;
+        mutable std::mutex mutex_;
+        std::condition_variable jobAdded_;
+        std::condition_variable jobTaken_;
+        std::deque<Job> jobs_;
+        std::size_t busyWorkers_ = 0;
+        bool stopping_ = false;
+        FrameCaptureStats stats_;  // guarded by mutex_
+};
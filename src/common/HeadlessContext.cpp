@@ -0,0 +1,137 @@
+#include "HeadlessContext.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef COMMON_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::HeadlessContext(int width, int height, int majorVersion, int minorVersion)
+    : width_(width), height_(height) {
+#ifdef COMMON_HAS_EGL
+    // The surfaceless platform needs neither a display server nor a GPU
+    auto getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (!getPlatformDisplay) {
+        std::cerr << "EGL_EXT_platform_base is not supported\n";
+        return;
+    }
+    EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        std::cerr << "Failed to initialize the surfaceless EGL display\n";
+        return;
+    }
+    display_ = display;
+
+    // Without surfaces there is no need for a config (EGL_KHR_no_config_context)
+    const EGLint attributes[] = {EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+                                 EGL_CONTEXT_MINOR_VERSION, minorVersion,
+                                 EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                 EGL_NONE};
+    eglBindAPI(EGL_OPENGL_API);
+    EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "Failed to create a headless OpenGL " << majorVersion << "." << minorVersion << " context\n";
+        return;
+    }
+    context_ = context;
+
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress))) {
+        std::cerr << "Failed to initialize GLAD\n";
+        return;
+    }
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+    if (width <= 0 || height <= 0 || width > maxSize || height > maxSize) {
+        std::cerr << "Invalid headless size " << width << "x" << height << ", each side must be 1 to " << maxSize << '\n';
+        return;
+    }
+
+    // Stands in for the default framebuffer
+    while (glGetError() != GL_NO_ERROR) {}
+    glGenRenderbuffers(1, &colorBuffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    const GLenum storageError = glGetError();  // GL_OUT_OF_MEMORY leaves the renderbuffer without storage
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer_);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (storageError != GL_NO_ERROR || status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Failed to create the " << width << "x" << height << " headless framebuffer (error 0x" << std::hex
+                  << storageError << ", status 0x" << status << std::dec << ")\n";
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer_);
+        glDeleteRenderbuffers(1, &colorBuffer_);
+        framebuffer_ = 0;
+        colorBuffer_ = 0;
+        return;
+    }
+    glViewport(0, 0, width, height);
+#else
+    (void)majorVersion;
+    (void)minorVersion;
+    std::cerr << "Built without EGL, headless rendering is not available\n";
+#endif
+}
+
+HeadlessContext::~HeadlessContext() {
+#ifdef COMMON_HAS_EGL
+    if (framebuffer_) {
+        glDeleteFramebuffers(1, &framebuffer_);
+        glDeleteRenderbuffers(1, &colorBuffer_);
+    }
+    if (context_) {
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display_, context_);
+    }
+    if (display_) eglTerminate(display_);
+#endif
+}
+
+bool HeadlessContext::writePpm(const std::string& path) const {
+    if (!valid()) return false;
+
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(width_) * height_ * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width_, height_, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << '\n';
+        return false;
+    }
+    file << "P6\n" << width_ << ' ' << height_ << "\n255\n";
+    const std::size_t rowSize = static_cast<std::size_t>(width_) * 3;
+    for (int y = height_ - 1; y >= 0; y--) {  // PPM starts at the top, glReadPixels at the bottom
+        file.write(reinterpret_cast<const char*>(pixels.data() + y * rowSize), rowSize);
+    }
+    if (!file) {
+        std::cerr << "Failed to write " << path << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            options.enabled = true;
+        } else if (arg == "--size" && i + 2 < argc) {
+            options.width = std::stoi(argv[++i]);
+            options.height = std::stoi(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            std::cerr << "Unknown argument: " << arg << '\n';
+            return false;
+        }
+    }
+    return true;
+}
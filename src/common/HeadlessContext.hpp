@@ -0,0 +1,44 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <string>
+
+// OpenGL context without a window or a display: EGL on the surfaceless platform (EGL_MESA_platform_surfaceless). On
+// machines without a GPU Mesa renders with llvmpipe. There is no default framebuffer, everything is drawn into a
+// framebuffer object of the requested size, which is bound (with a matching viewport) when the constructor returns.
+// GLAD is loaded by the constructor as well.
+class HeadlessContext {
+    public:
+        HeadlessContext(int width, int height, int majorVersion = 3, int minorVersion = 3);
+        ~HeadlessContext();
+        HeadlessContext(const HeadlessContext&) = delete;
+        HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+        // false if no context or no framebuffer of that size could be created, the reason went to std::cerr
+        bool valid() const { return framebuffer_ != 0; }
+
+        GLuint framebuffer() const { return framebuffer_; }
+        int width() const { return width_; }
+        int height() const { return height_; }
+
+        // Reads the framebuffer back and writes it as binary PPM (top row first)
+        bool writePpm(const std::string& path) const;
+
+    private:
+        int width_;
+        int height_;
+        void* display_ = nullptr;  // EGLDisplay
+        void* context_ = nullptr;  // EGLContext
+        GLuint framebuffer_ = 0;
+        GLuint colorBuffer_ = 0;
+};
+
+// Command line of the simple demos: --headless [--size W H] [--output image.ppm]. The caller fills in the defaults,
+// returns false (after telling std::cerr) for anything else.
+struct HeadlessOptions {
+    bool enabled = false;
+    int width;
+    int height;
+    std::string output;
+};
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions& options);
@@ -0,0 +1,180 @@
+#include "ImageEncoders.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+    void putBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+
+    uint32_t crc32(const uint8_t* data, std::size_t size) {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> entries{};
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+            return entries;
+        }();
+        uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    // Length, type, data, CRC of type and data
+    void putChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+        putBigEndian(out, static_cast<uint32_t>(data.size()));
+        std::size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        putBigEndian(out, crc32(out.data() + start, out.size() - start));
+    }
+
+    struct QoiPixel {
+        uint8_t r, g, b, a;
+        bool operator==(const QoiPixel& other) const {
+            return r == other.r && g == other.g && b == other.b && a == other.a;
+        }
+    };
+}  // namespace
+
+bool parseImageFormat(const std::string& name, ImageFormat& format) {
+    for (ImageFormat candidate : {ImageFormat::Png, ImageFormat::Qoi, ImageFormat::Raw}) {
+        if (name == imageFormatExtension(candidate) + 1) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* imageFormatExtension(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::Png: return ".png";
+        case ImageFormat::Qoi: return ".qoi";
+        case ImageFormat::Raw: return ".raw";
+    }
+    return "";
+}
+
+std::vector<uint8_t> encodeImage(ImageFormat format, int width, int height, const uint8_t* rgba) {
+    switch (format) {
+        case ImageFormat::Png: return encodePng(width, height, rgba);
+        case ImageFormat::Qoi: return encodeQoi(width, height, rgba);
+        case ImageFormat::Raw: return std::vector<uint8_t>(rgba, rgba + static_cast<std::size_t>(width) * height * 4);
+    }
+    return {};
+}
+
+// Every row is filter type 0 (none) and the zlib stream only has stored blocks, so encoding is a copy plus checksums
+std::vector<uint8_t> encodePng(int width, int height, const uint8_t* rgba) {
+    const std::size_t rowSize = static_cast<std::size_t>(width) * 4;
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve((rowSize + 1) * height);
+    for (int y = 0; y < height; y++) {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rgba + y * rowSize, rgba + (y + 1) * rowSize);
+    }
+
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    const std::size_t maxBlock = 65535;
+    std::size_t offset = 0;
+    do {
+        std::size_t size = std::min(maxBlock, scanlines.size() - offset);
+        bool last = offset + size == scanlines.size();
+        zlib.push_back(last ? 1 : 0);  // BFINAL, BTYPE = 00 (stored)
+        zlib.push_back(static_cast<uint8_t>(size));
+        zlib.push_back(static_cast<uint8_t>(size >> 8));
+        zlib.push_back(static_cast<uint8_t>(~size));
+        zlib.push_back(static_cast<uint8_t>(~size >> 8));
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + size);
+        offset += size;
+    } while (offset < scanlines.size());
+
+    // Adler-32, the sums are reduced before they can overflow
+    uint32_t a = 1, b = 0;
+    for (std::size_t i = 0; i < scanlines.size();) {
+        std::size_t end = std::min(scanlines.size(), i + 5552);
+        for (; i < end; i++) {
+            a += scanlines[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    putBigEndian(zlib, (b << 16) | a);
+
+    std::vector<uint8_t> header;
+    putBigEndian(header, width);
+    putBigEndian(header, height);
+    header.insert(header.end(), {8, 6, 0, 0, 0});  // 8 bit RGBA, deflate, no filter method, no interlace
+
+    std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.reserve(zlib.size() + 64);
+    putChunk(out, "IHDR", header);
+    putChunk(out, "IDAT", zlib);
+    putChunk(out, "IEND", {});
+    return out;
+}
+
+// The Quite OK Image format (qoiformat.org), one pass over the pixels with a 64 entry color cache
+std::vector<uint8_t> encodeQoi(int width, int height, const uint8_t* rgba) {
+    std::vector<uint8_t> out = {'q', 'o', 'i', 'f'};
+    putBigEndian(out, width);
+    putBigEndian(out, height);
+    out.push_back(4);  // RGBA
+    out.push_back(0);  // sRGB with linear alpha
+
+    std::array<QoiPixel, 64> seen{};
+    QoiPixel previous{0, 0, 0, 255};
+    int run = 0;
+    const std::size_t pixelCount = static_cast<std::size_t>(width) * height;
+    for (std::size_t i = 0; i < pixelCount; i++) {
+        QoiPixel pixel;
+        std::memcpy(&pixel, rgba + i * 4, 4);
+
+        if (pixel == previous) {
+            run++;
+            if (run == 62 || i + 1 == pixelCount) {
+                out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));  // QOI_OP_RUN
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+            run = 0;
+        }
+
+        int hash = (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+        if (seen[hash] == pixel) {
+            out.push_back(static_cast<uint8_t>(hash));  // QOI_OP_INDEX
+        } else {
+            seen[hash] = pixel;
+            if (pixel.a == previous.a) {
+                int dr = static_cast<int8_t>(pixel.r - previous.r);
+                int dg = static_cast<int8_t>(pixel.g - previous.g);
+                int db = static_cast<int8_t>(pixel.b - previous.b);
+                int drg = dr - dg;
+                int dbg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {  // QOI_OP_DIFF
+                    out.push_back(static_cast<uint8_t>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                } else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 && dbg >= -8 && dbg <= 7) {  // QOI_OP_LUMA
+                    out.push_back(static_cast<uint8_t>(0x80 | (dg + 32)));
+                    out.push_back(static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8)));
+                } else {
+                    out.insert(out.end(), {0xFE, pixel.r, pixel.g, pixel.b});  // QOI_OP_RGB
+                }
+            } else {
+                out.insert(out.end(), {0xFF, pixel.r, pixel.g, pixel.b, pixel.a});  // QOI_OP_RGBA
+            }
+        }
+        previous = pixel;
+    }
+
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});  // end marker
+    return out;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// File formats of captured frames. Png is uncompressed (stored deflate blocks) and needs no dependency, Qoi compresses
+// about as well as a fast PNG encoder at a fraction of the cost, Raw is the bare RGBA bytes.
+enum class ImageFormat { Png, Qoi, Raw };
+
+bool parseImageFormat(const std::string& name, ImageFormat& format);
+// File extension including the dot
+const char* imageFormatExtension(ImageFormat format);
+
+// Encodes width * height RGBA8 pixels (top row first) into a complete file
+std::vector<uint8_t> encodeImage(ImageFormat format, int width, int height, const uint8_t* rgba);
+std::vector<uint8_t> encodePng(int width, int height, const uint8_t* rgba);
+std::vector<uint8_t> encodeQoi(int width, int height, const uint8_t* rgba);
@@ -0,0 +1,125 @@
+#include "ProgramCache.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace {
+    // File layout: magic, binary format (GLenum), then the binary
+    const char binaryMagic[4] = {'G', 'L', 'P', 'B'};
+    const char* binaryExtension = ".glbin";
+
+    ProgramCache* activeCache = nullptr;
+
+    // FNV-1a, the terminating zero goes in as well so "ab" + "c" and "a" + "bc" differ
+    void hashString(uint64_t& hash, const char* text) {
+        if (!text) text = "";
+        for (const char* c = text;; c++) {
+            hash ^= static_cast<unsigned char>(*c);
+            hash *= 1099511628211ull;
+            if (!*c) break;
+        }
+    }
+}
+
+ProgramCache::ProgramCache(std::string directory) : directory_(std::move(directory)) {}
+
+bool ProgramCache::supported() {
+    if (!GLAD_GL_VERSION_4_1) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+ProgramCache* ProgramCache::active() { return activeCache; }
+
+void ProgramCache::setActive(ProgramCache* cache) { activeCache = cache; }
+
+std::string ProgramCache::key(const ShaderStages& stages) const {
+    uint64_t hash = 14695981039346656037ull;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        hashString(hash, reinterpret_cast<const char*>(glGetString(name)));
+    }
+    for (const auto& stage : stages) {
+        hashString(hash, std::to_string(stage.first).c_str());
+        hashString(hash, stage.second);
+    }
+
+    static const char digits[] = "0123456789abcdef";
+    std::string key(16, '0');
+    for (int i = 15; i >= 0; i--, hash >>= 4) key[i] = digits[hash & 0xf];
+    return key;
+}
+
+bool ProgramCache::load(const std::string& key, GLuint program) {
+    auto start = std::chrono::steady_clock::now();
+    std::ifstream file(path(key), std::ios::binary);
+    if (!file) return false;
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+
+    const std::size_t header = sizeof(binaryMagic) + sizeof(GLenum);
+    bool linked = false;
+    if (contents.size() > header && std::memcmp(contents.data(), binaryMagic, sizeof(binaryMagic)) == 0) {
+        GLenum format;
+        std::memcpy(&format, contents.data() + sizeof(binaryMagic), sizeof(format));
+        glProgramBinary(program, format, contents.data() + header, static_cast<GLsizei>(contents.size() - header));
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        linked = success != 0;
+    }
+    if (!linked) {
+        // Truncated, or from a driver that hashes the same but can't read it, compiling writes a new one
+        std::error_code error;
+        std::filesystem::remove(path(key), error);
+        stats_.rejected++;
+        return false;
+    }
+
+    stats_.hits++;
+    stats_.hitMilliseconds +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void ProgramCache::store(const std::string& key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+
+    // Written under a temporary name and renamed, a second instance never reads half a file
+    const std::string temporary = path(key) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        file.write(binaryMagic, sizeof(binaryMagic));
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(binary.data(), length);
+        if (!file) return;
+    }
+    std::filesystem::rename(temporary, path(key), error);
+    if (!error) stats_.stored++;
+}
+
+void ProgramCache::clear() {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+        if (entry.path().extension() == binaryExtension) std::filesystem::remove(entry.path(), error);
+    }
+}
+
+void ProgramCache::countMiss(double milliseconds) {
+    stats_.misses++;
+    stats_.missMilliseconds += milliseconds;
+}
+
+std::string ProgramCache::path(const std::string& key) const { return directory_ + "/" + key + binaryExtension; }
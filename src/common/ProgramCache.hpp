@@ -0,0 +1,63 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Shader stages of a program: type (GL_VERTEX_SHADER, ...) and complete source, #version and defines included
+using ShaderStages = std::vector<std::pair<GLenum, const char*>>;
+
+// Statistics of a cache session
+struct ProgramCacheStats {
+    std::size_t hits = 0;        // programs loaded with glProgramBinary
+    std::size_t misses = 0;      // programs compiled from source
+    std::size_t rejected = 0;    // binaries the driver refused (driver update), counted as misses as well
+    std::size_t stored = 0;      // binaries written after a miss
+    double hitMilliseconds = 0.0;   // loading
+    double missMilliseconds = 0.0;  // compiling, linking and storing
+};
+
+// On-disk cache of linked programs (glGetProgramBinary, OpenGL 4.1). A binary is stored under a hash of the stage
+// sources and the driver (vendor, renderer and version strings), so an edited shader, a different define set (the
+// defines are part of the source) or a driver update never loads a stale binary. A binary the driver rejects anyway
+// is deleted and the program compiled again.
+//
+// Shader consults the active cache, so every program created through Shader or createShaderProgram is cached once an
+// application activates one.
+class ProgramCache {
+    public:
+        // The directory is created when the first binary is stored
+        explicit ProgramCache(std::string directory);
+        ProgramCache(const ProgramCache&) = delete;
+        ProgramCache& operator=(const ProgramCache&) = delete;
+
+        // Whether the context can return program binaries at all (4.1 and at least one binary format)
+        static bool supported();
+
+        // The cache Shader uses, nullptr (the default) compiles everything
+        static ProgramCache* active();
+        static void setActive(ProgramCache* cache);
+
+        // Key of the stages on the current context's driver
+        std::string key(const ShaderStages& stages) const;
+
+        // Loads and links the binary of the key into program, false on a miss
+        bool load(const std::string& key, GLuint program);
+        // Writes the binary of the linked program (linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+        void store(const std::string& key, GLuint program);
+
+        // Deletes all cached binaries, for measuring a cold start
+        void clear();
+
+        void countMiss(double milliseconds);
+        const ProgramCacheStats& stats() const { return stats_; }
+        const std::string& directory() const { return directory_; }
+
+    private:
+        std::string path(const std::string& key) const;
+
+        std::string directory_;
+        ProgramCacheStats stats_;
+};
@@ -0,0 +1,178 @@
+#include "Shader.hpp"
+
+#include <iostream>
+#include <utility>
+
+namespace {
+    // The whole info log of a shader or a program, GL_INFO_LOG_LENGTH long
+    std::string infoLog(GLuint object, PFNGLGETSHADERIVPROC getLength, PFNGLGETSHADERINFOLOGPROC getLog) {
+        GLint length = 0;
+        getLength(object, GL_INFO_LOG_LENGTH, &length);
+        if (length <= 0) return {};
+        std::string log(static_cast<std::size_t>(length), '\0');
+        GLsizei written = 0;
+        getLog(object, length, &written, &log[0]);
+        log.resize(static_cast<std::size_t>(written));
+        return log;
+    }
+
+    const char* stageName(GLint type) {
+        switch (type) {
+            case GL_VERTEX_SHADER: return "vertex";
+            case GL_FRAGMENT_SHADER: return "fragment";
+            case GL_GEOMETRY_SHADER: return "geometry";
+            case GL_COMPUTE_SHADER: return "compute";
+            default: return "tessellation";
+        }
+    }
+
+    // " of name", nothing for programs without a name
+    std::string named(const std::string& name) { return name.empty() ? std::string() : " of " + name; }
+
+    // Errors of a compiled stage, asked for only after the program was linked
+    void reportCompileErrors(GLuint shader, const std::string& name) {
+        int success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLint type = 0;
+            glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+            std::cerr << "Error compiling " << stageName(type) << " shader" << named(name) << ":\n"
+                      << infoLog(shader, glGetShaderiv, glGetShaderInfoLog) << '\n';
+        }
+    }
+}
+
+Shader::Shader(const char* vertexSource, const char* fragmentSource) {
+    begin({{GL_VERTEX_SHADER, vertexSource}, {GL_FRAGMENT_SHADER, fragmentSource}});
+    finish();
+}
+
+Shader::Shader(const char* computeSource) {
+    begin({{GL_COMPUTE_SHADER, computeSource}});
+    finish();
+}
+
+Shader::Shader(const ShaderStages& stages, std::string name) : name_(std::move(name)) {
+    begin(stages);
+    finish();
+}
+
+Shader::Shader(const SpirvStages& stages) {
+    program_ = glCreateProgram();
+    started_ = std::chrono::steady_clock::now();
+    for (const SpirvStage& stage : stages) {
+        GLuint shader = glCreateShader(stage.type);
+        glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V, stage.module, stage.size);
+        glSpecializeShader(shader, "main", 0, nullptr, nullptr);  // sets the compile status
+        glAttachShader(program_, shader);
+        shaders_.push_back(shader);
+    }
+    glLinkProgram(program_);
+    finish();
+}
+
+bool Shader::spirvSupported() {
+    if (!GLAD_GL_VERSION_4_6) return false;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_SHADER_BINARY_FORMATS, &count);
+    std::vector<GLint> formats(static_cast<std::size_t>(count));
+    if (count > 0) glGetIntegerv(GL_SHADER_BINARY_FORMATS, formats.data());
+    for (GLint format : formats) {
+        if (format == GL_SHADER_BINARY_FORMAT_SPIR_V) return true;
+    }
+    return false;
+}
+
+Shader::~Shader() {
+    for (GLuint shader : shaders_) glDeleteShader(shader);
+    if (program_) glDeleteProgram(program_);
+}
+
+Shader::Shader(Shader&& other) noexcept
+    : program_(std::exchange(other.program_, 0)),
+      linked_(other.linked_),
+      fromCache_(other.fromCache_),
+      shaders_(std::move(other.shaders_)),
+      cacheKey_(std::move(other.cacheKey_)),
+      name_(std::move(other.name_)),
+      started_(other.started_) {
+    other.shaders_.clear();
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept {
+    if (this != &other) {
+        for (GLuint shader : shaders_) glDeleteShader(shader);
+        if (program_) glDeleteProgram(program_);
+        program_ = std::exchange(other.program_, 0);
+        linked_ = other.linked_;
+        fromCache_ = other.fromCache_;
+        shaders_ = std::move(other.shaders_);
+        other.shaders_.clear();
+        cacheKey_ = std::move(other.cacheKey_);
+        name_ = std::move(other.name_);
+        started_ = other.started_;
+    }
+    return *this;
+}
+
+GLuint Shader::release() { return std::exchange(program_, 0); }
+
+Shader Shader::start(const ShaderStages& stages, std::string name) {
+    Shader shader;
+    shader.name_ = std::move(name);
+    shader.begin(stages);
+    return shader;
+}
+
+void Shader::begin(const ShaderStages& stages) {
+    program_ = glCreateProgram();
+
+    ProgramCache* cache = ProgramCache::supported() ? ProgramCache::active() : nullptr;
+    if (cache) {
+        cacheKey_ = cache->key(stages);
+        if (cache->load(cacheKey_, program_)) {
+            linked_ = true;
+            fromCache_ = true;
+            return;
+        }
+    }
+
+    // No status queries in between, each one would wait for the compiler
+    started_ = std::chrono::steady_clock::now();
+    for (const auto& stage : stages) {
+        GLuint shader = glCreateShader(stage.first);
+        glShaderSource(shader, 1, &stage.second, nullptr);
+        glCompileShader(shader);
+        glAttachShader(program_, shader);
+        shaders_.push_back(shader);
+    }
+    if (cache) glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program_);
+}
+
+void Shader::finish() {
+    if (!pending()) return;
+
+    for (GLuint shader : shaders_) reportCompileErrors(shader, name_);
+    int success;
+    glGetProgramiv(program_, GL_LINK_STATUS, &success);
+    if (!success) {
+        std::cerr << "Error linking program" << named(name_) << ":\n"
+                  << infoLog(program_, glGetProgramiv, glGetProgramInfoLog) << '\n';
+    }
+    linked_ = success != 0;
+
+    for (GLuint shader : shaders_) {
+        glDetachShader(program_, shader);
+        glDeleteShader(shader);
+    }
+    shaders_.clear();
+
+    // Broken programs aren't stored, the next start reports the error again
+    ProgramCache* cache = cacheKey_.empty() ? nullptr : ProgramCache::active();
+    if (cache) {
+        if (linked_) cache->store(cacheKey_, program_);
+        cache->countMiss(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started_).count());
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ProgramCache.hpp"
+
+// SPIR-V module of a stage (OpenGL 4.6): type (GL_VERTEX_SHADER, ...), the module and its size in bytes
+struct SpirvStage {
+    GLenum type;
+    const void* module;
+    GLsizei size;
+};
+using SpirvStages = std::vector<SpirvStage>;
+
+// A linked GLSL program that owns its id. It is loaded from the active ProgramCache when that has the binary and
+// compiled from the sources otherwise (then stored in the cache). Compile and link errors go to std::cerr like with
+// createShaderProgram, the program is still created so the caller can go on.
+//
+// All stages are compiled and the program linked before the driver is asked for any status, so a driver with
+// compiler threads works on the stages at the same time.
+class Shader {
+    public:
+        Shader(const char* vertexSource, const char* fragmentSource);
+        // Compute program (OpenGL 4.3)
+        explicit Shader(const char* computeSource);
+        // name (a file or a permutation key) goes into the compile and link errors
+        explicit Shader(const ShaderStages& stages, std::string name = {});
+        // Program of precompiled SPIR-V modules, specialized at main with the default constants. Never cached, there
+        // is nothing left to compile.
+        explicit Shader(const SpirvStages& stages);
+        ~Shader();
+        Shader(Shader&& other) noexcept;
+        Shader& operator=(Shader&& other) noexcept;
+        Shader(const Shader&) = delete;
+        Shader& operator=(const Shader&) = delete;
+
+        // Whether the context takes SPIR-V modules (OpenGL 4.6)
+        static bool spirvSupported();
+
+        // Activate / deactivate
+        void use() const { glUseProgram(program_); }
+        static void unuse() { glUseProgram(0); }
+
+        GLuint id() const { return program_; }
+        bool linked() const { return linked_; }
+        // Whether the program came from the cache instead of the compiler
+        bool fromCache() const { return fromCache_; }
+
+        // Hands the program over to the caller, who deletes it. The Shader is empty afterwards.
+        GLuint release();
+
+        // Deferred build for ShaderBuildQueue: start returns right after glLinkProgram, finish checks the stages and
+        // the link (waiting for the driver if it isn't done) and stores the binary. The constructors do both at once.
+        static Shader start(const ShaderStages& stages, std::string name = {});
+        void finish();
+        // Started and not finished yet, linked() is false until finish
+        bool pending() const { return !shaders_.empty(); }
+
+    private:
+        Shader() = default;
+        void begin(const ShaderStages& stages);
+
+        GLuint program_ = 0;
+        bool linked_ = false;
+        bool fromCache_ = false;
+        std::vector<GLuint> shaders_;  // of a pending build
+        std::string cacheKey_;
+        std::string name_;
+        std::chrono::steady_clock::time_point started_;
+};
@@ -0,0 +1,106 @@
+#include "ShaderBuildQueue.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+    // GL_KHR_parallel_shader_compile, the glad loader is core only
+    const GLenum completionStatus = 0x91B1;  // GL_COMPLETION_STATUS_KHR
+
+    ShaderBuildQueue* activeQueue = nullptr;
+}
+
+ShaderBuildQueue::ShaderBuildQueue() : parallel_(parallelSupported()) {}
+
+ShaderBuildQueue::~ShaderBuildQueue() {
+    // The owners delete the programs, only the stage objects of unfinished builds go with the Shaders
+    for (Build& build : pending_) build.shader.release();
+}
+
+bool ShaderBuildQueue::parallelSupported() {
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions; i++) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0 ||
+                     std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ShaderBuildQueue* ShaderBuildQueue::active() { return activeQueue; }
+
+void ShaderBuildQueue::setActive(ShaderBuildQueue* queue) { activeQueue = queue; }
+
+GLuint ShaderBuildQueue::submit(const ShaderStages& stages, Setup setup, std::string name) {
+    auto start = std::chrono::steady_clock::now();
+    Build build{Shader::start(stages, std::move(name)), std::move(setup), start};
+    stats_.submitted++;
+
+    GLuint program = build.shader.id();
+    failed_.erase(program);  // the name of a deleted program comes back
+    if (!build.shader.pending()) {
+        stats_.fromCache++;
+        complete(build);
+    } else {
+        pending_.push_back(std::move(build));
+        stats_.maxInFlight = std::max(stats_.maxInFlight, pending_.size());
+    }
+    stats_.submitMilliseconds +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return program;
+}
+
+std::size_t ShaderBuildQueue::poll() {
+    if (pending_.empty()) return 0;
+
+    if (!parallel_) {
+        // Can't ask, the oldest one has had the most time
+        stats_.blockingFinishes++;
+        complete(pending_.front());
+        pending_.erase(pending_.begin());
+        return 1;
+    }
+
+    std::size_t finished = 0;
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(it->shader.id(), completionStatus, &done);
+        if (done) {
+            complete(*it);
+            it = pending_.erase(it);
+            finished++;
+        } else {
+            ++it;
+        }
+    }
+    return finished;
+}
+
+void ShaderBuildQueue::finish() {
+    stats_.blockingFinishes += pending_.size();
+    for (Build& build : pending_) complete(build);
+    pending_.clear();
+}
+
+bool ShaderBuildQueue::ready(GLuint program) const {
+    return std::none_of(pending_.begin(), pending_.end(),
+                        [program](const Build& build) { return build.shader.id() == program; });
+}
+
+void ShaderBuildQueue::complete(Build& build) {
+    build.shader.finish();
+    if (!build.shader.linked()) {
+        stats_.failed++;
+        failed_.insert(build.shader.id());
+    }
+    stats_.longestBuildMilliseconds =
+        std::max(stats_.longestBuildMilliseconds,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build.submitted).count());
+
+    GLuint program = build.shader.release();
+    if (build.setup) build.setup(program);
+}
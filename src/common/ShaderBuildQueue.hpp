@@ -0,0 +1,85 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "Shader.hpp"
+
+// Statistics of a build queue
+struct ShaderBuildStats {
+    std::size_t submitted = 0;
+    std::size_t fromCache = 0;         // ready at submit, loaded from the ProgramCache
+    std::size_t failed = 0;            // compile or link errors
+    std::size_t maxInFlight = 0;       // most programs building at the same time
+    std::size_t blockingFinishes = 0;  // finished without knowing that the driver was done, see poll
+    double submitMilliseconds = 0.0;   // main thread time in submit: starting compiles and loading binaries
+    double longestBuildMilliseconds = 0.0;  // submit to ready
+};
+
+// Builds programs without waiting for the driver. submit starts compiling and linking a program (through
+// Shader::start, so the ProgramCache is used) and returns its name at once, poll finishes the programs the driver is
+// done with: the compile and link status is checked then, and the setup callback (block bindings, sampler units,
+// uniform locations) runs. A program can't be drawn with before it is ready.
+//
+// With GL_KHR_parallel_shader_compile (or the ARB version) the driver compiles on its own threads and
+// GL_COMPLETION_STATUS_KHR tells without blocking whether a program is done. The thread count is left at the
+// extension's default, all the driver wants to use. Without the extension there is no way to ask, so poll finishes
+// one program per call, which at least spreads the stalls over the frames.
+//
+// The owner of a pending program has to stay alive until the program is ready (its setup refers to it), finish
+// completes everything before the owners go away.
+class ShaderBuildQueue {
+    public:
+        using Setup = std::function<void(GLuint program)>;
+
+        ShaderBuildQueue();
+        ~ShaderBuildQueue();
+        ShaderBuildQueue(const ShaderBuildQueue&) = delete;
+        ShaderBuildQueue& operator=(const ShaderBuildQueue&) = delete;
+
+        // Whether the current context has the extension (GL_COMPLETION_STATUS_KHR can be queried)
+        static bool parallelSupported();
+
+        // The queue buildShaderProgram uses, nullptr (the default) builds right away
+        static ShaderBuildQueue* active();
+        static void setActive(ShaderBuildQueue* queue);
+
+        // The caller owns the program like with createShaderProgram. A cached program is ready (and set up) at once.
+        // name goes into the compile and link errors, see Shader.
+        GLuint submit(const ShaderStages& stages, Setup setup = {}, std::string name = {});
+
+        // Finishes what is done, returns how many programs got ready
+        std::size_t poll();
+        // Finishes all programs, blocking
+        void finish();
+
+        // Not pending (programs the queue never saw count as ready). A program that failed is ready as well, it just
+        // can't be drawn with: see failed.
+        bool ready(GLuint program) const;
+        // Finished with compile or link errors
+        bool failed(GLuint program) const { return failed_.count(program) != 0; }
+        bool idle() const { return pending_.empty(); }
+
+        bool parallel() const { return parallel_; }
+        const ShaderBuildStats& stats() const { return stats_; }
+
+    private:
+        struct Build {
+            Shader shader;
+            Setup setup;
+            std::chrono::steady_clock::time_point submitted;
+        };
+
+        // Checks the result, hands the program to its owner and runs the setup
+        void complete(Build& build);
+
+        std::vector<Build> pending_;  // in submit order
+        std::unordered_set<GLuint> failed_;
+        bool parallel_ = false;
+        ShaderBuildStats stats_;
+};
@@ -0,0 +1,103 @@
+#include "ShaderPermutationCache.hpp"
+
+#include <iostream>
+
+#include "ShaderUtils.hpp"
+
+ShaderPermutationCache::ShaderPermutationCache(const ShaderPreprocessor& preprocessor,
+                                               ShaderSourceNames stages,
+                                               Setup setup)
+    : preprocessor_(preprocessor), stages_(std::move(stages)), setup_(std::move(setup)) {
+    for (const auto& stage : stages_) name_ += (name_.empty() ? "" : "+") + stage.second;
+}
+
+ShaderPermutationCache::~ShaderPermutationCache() {
+    for (const auto& entry : programs_) {
+        if (entry.second) glDeleteProgram(entry.second);
+    }
+    for (const auto& entry : rebuilt_) glDeleteProgram(entry.second);
+}
+
+GLuint ShaderPermutationCache::program(const ShaderDefines& defines) {
+    std::string permutation = key(defines);
+    auto found = programs_.find(permutation);
+    if (found != programs_.end()) {
+        if (permutation != last_) reused_++;
+        last_ = std::move(permutation);
+        return found->second;
+    }
+    last_ = permutation;
+    return create(permutation, defines);
+}
+
+void ShaderPermutationCache::prewarm(const std::vector<ShaderDefines>& permutations) {
+    for (const ShaderDefines& defines : permutations) {
+        std::string permutation = key(defines);
+        if (!programs_.count(permutation)) create(permutation, defines);
+    }
+}
+
+void ShaderPermutationCache::reload() {
+    if (!rebuilt_.empty()) {
+        reloadAgain_ = true;
+        return;
+    }
+    // The sources that didn't preprocess may have been fixed, they are tried again on their next request
+    failed_.clear();
+    for (const auto& entry : defines_) {
+        GLuint program = build(entry.first, entry.second);
+        if (program) rebuilt_[entry.first] = program;
+    }
+    reloads_++;
+}
+
+bool ShaderPermutationCache::update() {
+    bool swapped = false;
+    for (auto entry = rebuilt_.begin(); entry != rebuilt_.end();) {
+        if (!shaderProgramReady(entry->second)) {
+            ++entry;
+            continue;
+        }
+        if (shaderProgramFailed(entry->second)) {
+            glDeleteProgram(entry->second);
+        } else {
+            GLuint& program = programs_[entry->first];
+            glDeleteProgram(program);
+            program = entry->second;
+            swapped = true;
+        }
+        entry = rebuilt_.erase(entry);
+    }
+    if (rebuilt_.empty() && reloadAgain_) {
+        reloadAgain_ = false;
+        reload();
+    }
+    return swapped;
+}
+
+std::string ShaderPermutationCache::key(const ShaderDefines& defines) const { return permutationKey(name_, defines); }
+
+GLuint ShaderPermutationCache::create(const std::string& permutation, const ShaderDefines& defines) {
+    // A failed permutation is reported once and not tried again, the sources are the same next time
+    if (failed_.count(permutation)) return 0;
+    GLuint program = build(permutation, defines);
+    if (!program) {
+        failed_.insert(permutation);
+        return 0;
+    }
+    defines_[permutation] = defines;
+    return programs_[permutation] = program;
+}
+
+GLuint ShaderPermutationCache::build(const std::string& permutation, const ShaderDefines& defines) const {
+    std::vector<std::string> sources(stages_.size());
+    for (std::size_t i = 0; i < stages_.size(); i++) {
+        if (!preprocessor_.process(stages_[i].second, defines, sources[i])) {
+            std::cerr << "Failed to preprocess " << permutation << '\n';
+            return 0;
+        }
+    }
+    ShaderStages stages;
+    for (std::size_t i = 0; i < stages_.size(); i++) stages.emplace_back(stages_[i].first, sources[i].c_str());
+    return buildProgram(stages, setup_, permutation);
+}
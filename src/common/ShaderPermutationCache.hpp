@@ -0,0 +1,74 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ShaderPreprocessor.hpp"
+
+// Stages of a program by source name (see ShaderPreprocessor)
+using ShaderSourceNames = std::vector<std::pair<GLenum, std::string>>;
+
+// The programs of one set of stages by define set (a permutation), each built at most once and kept. All stages get
+// the same defines. The builds go through buildProgram, so the active ShaderBuildQueue and ProgramCache apply, and
+// prewarm can start the permutations known at load time without waiting for any of them.
+class ShaderPermutationCache {
+    public:
+        using Setup = std::function<void(GLuint program)>;
+
+        // setup runs for every program once it is linked (block bindings, sampler units). The preprocessor has to
+        // outlive the cache.
+        ShaderPermutationCache(const ShaderPreprocessor& preprocessor, ShaderSourceNames stages, Setup setup = {});
+        ~ShaderPermutationCache();
+        ShaderPermutationCache(const ShaderPermutationCache&) = delete;
+        ShaderPermutationCache& operator=(const ShaderPermutationCache&) = delete;
+
+        // The program of the permutation, built on the first request. 0 if a source couldn't be preprocessed, that
+        // permutation isn't cached and counts as failed.
+        GLuint program(const ShaderDefines& defines);
+
+        // Starts building the permutations that aren't there yet, doesn't count as reuse
+        void prewarm(const std::vector<ShaderDefines>& permutations);
+
+        // Builds every permutation again from the current sources, after the shader files changed. The programs in use
+        // stay until update swaps the rebuilt ones in, one that doesn't build keeps its program (the errors go to
+        // std::cerr). Called while a reload is still building, it starts again once that one is done.
+        void reload();
+        // Swaps in the rebuilt programs that are ready, true if any was. Call it between frames, after the build
+        // queue's poll: the program of a permutation changes, so ask for it again before drawing.
+        bool update();
+
+        // "vertex+fragment[DEFINES]", see permutationKey
+        std::string key(const ShaderDefines& defines) const;
+
+        std::size_t created() const { return programs_.size(); }
+        // Switches back to a permutation built before. Asking for the previous one again (every frame) isn't reuse.
+        std::size_t reused() const { return reused_; }
+        std::size_t failed() const { return failed_.size(); }
+        std::size_t reloads() const { return reloads_; }
+
+    private:
+        GLuint create(const std::string& permutation, const ShaderDefines& defines);
+        // Preprocesses and submits the permutation, 0 (and the reason to std::cerr) if a source can't be preprocessed
+        GLuint build(const std::string& permutation, const ShaderDefines& defines) const;
+
+        const ShaderPreprocessor& preprocessor_;
+        ShaderSourceNames stages_;
+        std::string name_;  // the stage names joined with '+'
+        Setup setup_;
+        std::unordered_map<std::string, GLuint> programs_;        // by key
+        std::unordered_map<std::string, ShaderDefines> defines_;  // by key, to build the programs again
+        std::unordered_set<std::string> failed_;                  // keys that didn't preprocess
+        std::string last_;  // key of the previous program() request
+        std::size_t reused_ = 0;
+
+        // reload: the programs still building, by key, and whether another reload follows them
+        std::unordered_map<std::string, GLuint> rebuilt_;
+        bool reloadAgain_ = false;
+        std::size_t reloads_ = 0;
+};
@@ -0,0 +1,116 @@
+#include "ShaderPreprocessor.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "ShaderUtils.hpp"
+
+namespace {
+    // The line without leading blanks, "" for blank lines
+    std::string trimmed(const std::string& line) {
+        std::size_t start = line.find_first_not_of(" \t");
+        return start == std::string::npos ? std::string() : line.substr(start);
+    }
+
+    bool isDirective(const std::string& line, const char* directive) {
+        std::string text = trimmed(line);
+        if (text.empty() || text[0] != '#') return false;
+        std::size_t start = text.find_first_not_of(" \t", 1);
+        std::size_t length = std::char_traits<char>::length(directive);
+        if (start == std::string::npos || text.compare(start, length, directive) != 0) return false;
+        // The whole name, #includes isn't #include
+        std::size_t end = start + length;
+        return end == text.size() || text[end] == ' ' || text[end] == '\t' || text[end] == '"';
+    }
+
+    // The quoted name of an #include line, "" if it has none
+    std::string includeName(const std::string& line) {
+        std::size_t open = line.find('"');
+        std::size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        return close == std::string::npos ? std::string() : line.substr(open + 1, close - open - 1);
+    }
+}
+
+std::string permutationKey(const std::string& name, const ShaderDefines& defines) {
+    std::string key = name + '[';
+    for (auto it = defines.begin(); it != defines.end(); ++it) {
+        if (it != defines.begin()) key += ',';
+        key += it->first;
+        if (!it->second.empty()) key += '=' + it->second;
+    }
+    return key + ']';
+}
+
+void ShaderPreprocessor::addSource(const std::string& name, std::string source) { sources_[name] = std::move(source); }
+
+void ShaderPreprocessor::addDirectory(const std::string& directory) { directories_.push_back(directory); }
+
+bool ShaderPreprocessor::process(const std::string& name, const ShaderDefines& defines, std::string& output) const {
+    std::vector<std::string> included;
+    output.clear();
+    return expand(name, included, &defines, output);
+}
+
+bool ShaderPreprocessor::find(const std::string& name, std::string& source) const {
+    auto registered = sources_.find(name);
+    if (registered != sources_.end()) {
+        source = registered->second;
+        return true;
+    }
+    for (const std::string& directory : directories_) {
+        std::ifstream probe(directory + '/' + name);
+        if (probe) return readShaderFile(directory + '/' + name, source);
+    }
+    std::cerr << "Shader source not found: " << name << '\n';
+    return false;
+}
+
+bool ShaderPreprocessor::expand(const std::string& name,
+                                std::vector<std::string>& included,
+                                const ShaderDefines* defines,
+                                std::string& output) const {
+    std::string source;
+    if (!find(name, source)) return false;
+
+    included.push_back(name);
+    const std::size_t sourceNumber = included.size() - 1;
+    bool versionFound = !defines;
+
+    std::istringstream lines(source);
+    std::string line;
+    for (int lineNumber = 1; std::getline(lines, line); lineNumber++) {
+        if (isDirective(line, "include")) {
+            std::string child = includeName(line);
+            if (child.empty()) {
+                std::cerr << name << ':' << lineNumber << ": #include needs a quoted name\n";
+                return false;
+            }
+            if (std::find(included.begin(), included.end(), child) == included.end()) {
+                output += "#line 1 " + std::to_string(included.size()) + '\n';
+                if (!expand(child, included, nullptr, output)) return false;
+            }
+            output += "#line " + std::to_string(lineNumber + 1) + ' ' + std::to_string(sourceNumber) + '\n';
+            continue;
+        }
+
+        output += line;
+        output += '\n';
+        if (!versionFound && isDirective(line, "version")) {
+            for (const auto& define : *defines) {
+                output += "#define " + define.first;
+                if (!define.second.empty()) output += ' ' + define.second;
+                output += '\n';
+            }
+            output += "#line " + std::to_string(lineNumber + 1) + " 0\n";
+            versionFound = true;
+        }
+    }
+
+    if (!versionFound) {
+        std::cerr << "Shader " << name << " has no #version line for the defines\n";
+        return false;
+    }
+    return true;
+}
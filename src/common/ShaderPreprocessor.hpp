@@ -0,0 +1,40 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Defines injected into a shader: name -> value ("" for a plain #define NAME). Ordered, so the same set always gives
+// the same source and the same key.
+using ShaderDefines = std::map<std::string, std::string>;
+
+// Key of a permutation: the name followed by the defines, "mandelbrot.frag[PRECISION_DOUBLE,STEPS=4]"
+std::string permutationKey(const std::string& name, const ShaderDefines& defines);
+
+// The GLSL preprocessing the driver doesn't do: #include "name" and injected defines. Names are looked up among the
+// sources added with addSource first (shaders compiled into the program), then in the directories in the order they
+// were added. A source is included once per shader (as if it had #pragma once), which makes include cycles harmless as
+// well. Includes are expanded whether or not an #if around them is taken.
+//
+// The defines go right after the #version line of the top source. #line directives keep the line numbers of error
+// messages: the source string number is the include order, 0 is the top source.
+class ShaderPreprocessor {
+    public:
+        void addSource(const std::string& name, std::string source);
+        void addDirectory(const std::string& directory);
+
+        // The complete source of the named shader, false (and the reason to std::cerr) if a source is missing or the
+        // top source has no #version line
+        bool process(const std::string& name, const ShaderDefines& defines, std::string& output) const;
+
+    private:
+        bool find(const std::string& name, std::string& source) const;
+        // defines is nullptr for included sources
+        bool expand(const std::string& name,
+                    std::vector<std::string>& included,
+                    const ShaderDefines* defines,
+                    std::string& output) const;
+
+        std::map<std::string, std::string> sources_;
+        std::vector<std::string> directories_;
+};
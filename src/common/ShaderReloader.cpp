@@ -0,0 +1,107 @@
+#include "ShaderReloader.hpp"
+
+#include <iostream>
+
+#include "Shader.hpp"
+#include "ShaderUtils.hpp"
+
+namespace {
+    // Editors write a file in several steps, the build waits until they have been quiet this long
+    const int settleMilliseconds = 50;
+    // How often the worker looks at the stop flag
+    const int stopPollMilliseconds = 100;
+}
+
+ShaderReloader::ShaderReloader(ShaderFiles files) : files_(std::move(files)) {
+    program_ = build(linked_);
+    if (!program_) program_ = glCreateProgram();  // unreadable files, draws nothing until they are fixed
+}
+
+ShaderReloader::ShaderReloader(ShaderFiles files, GLuint program)
+    : files_(std::move(files)), program_(program), linked_(true) {}
+
+ShaderReloader::~ShaderReloader() {
+    stop_ = true;
+    if (worker_.joinable()) worker_.join();
+    if (readyFence_) glDeleteSync(readyFence_);
+    if (readyProgram_) glDeleteProgram(readyProgram_);
+    glDeleteProgram(program_);
+}
+
+bool ShaderReloader::watch(ContextHook makeCurrent, ContextHook doneCurrent) {
+    if (!FileWatcher::supported() || worker_.joinable()) return false;
+    bool watching = false;
+    for (const auto& file : files_) watching = watcher_.watch(file.second) || watching;
+    if (!watching) return false;
+
+    worker_ = std::thread([this, makeCurrent = std::move(makeCurrent), doneCurrent = std::move(doneCurrent)]() {
+        run(makeCurrent, doneCurrent);
+    });
+    return true;
+}
+
+bool ShaderReloader::update() {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || !readyProgram_) return false;
+
+    // The link was issued on the other context, its fence tells when this one may use the program
+    if (glClientWaitSync(readyFence_, 0, 0) == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(readyFence_);
+    readyFence_ = nullptr;
+
+    glDeleteProgram(program_);
+    program_ = readyProgram_;
+    readyProgram_ = 0;
+    linked_ = true;
+    reloads_++;
+    return true;
+}
+
+GLuint ShaderReloader::build(bool& linked) const {
+    std::vector<std::string> sources(files_.size());
+    for (std::size_t i = 0; i < files_.size(); i++) {
+        if (!readShaderFile(files_[i].second, sources[i])) return 0;
+    }
+    ShaderStages stages;
+    std::string name;
+    for (std::size_t i = 0; i < files_.size(); i++) {
+        stages.emplace_back(files_[i].first, sources[i].c_str());
+        name += (i ? "+" : "") + files_[i].second;
+    }
+
+    Shader shader(stages, name);
+    linked = shader.linked();
+    return shader.release();
+}
+
+void ShaderReloader::run(const ContextHook& makeCurrent, const ContextHook& doneCurrent) {
+    makeCurrent();
+    while (!stop_) {
+        if (watcher_.wait(stopPollMilliseconds).empty()) continue;
+        while (!stop_ && !watcher_.wait(settleMilliseconds).empty()) {
+        }
+
+        bool linked = false;
+        GLuint program = build(linked);
+        if (!linked) {
+            if (program) glDeleteProgram(program);
+            failures_++;
+            std::cerr << "Shader reload failed, keeping the running program\n";
+            continue;
+        }
+
+        // Submitted before the fence, glFlush makes sure the fence reaches the GPU at all
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        // A newer edit than the one still waiting for its frame replaces it
+        if (readyProgram_) {
+            glDeleteSync(readyFence_);
+            glDeleteProgram(readyProgram_);
+        }
+        readyProgram_ = program;
+        readyFence_ = fence;
+    }
+    doneCurrent();
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "FileWatcher.hpp"
+
+// Shader files of a program: type (GL_VERTEX_SHADER, ...) and path
+using ShaderFiles = std::vector<std::pair<GLenum, std::string>>;
+
+// A program built from shader files that follows their edits. watch starts a thread that waits for changes (see
+// FileWatcher) and builds the changed program on its own context, which shares objects with the render context.
+// update, called by the render loop between frames, swaps the new program in once the fence behind its link has
+// signaled, so the render thread never waits for the compiler. A file that doesn't compile or link keeps the running
+// program, the error goes to std::cerr.
+//
+// The worker builds through Shader, without a ProgramCache active (the cache isn't thread-safe).
+class ShaderReloader {
+    public:
+        using ContextHook = std::function<void()>;
+
+        // Builds the files right away on the calling thread, see linked
+        explicit ShaderReloader(ShaderFiles files);
+        // Starts with a linked program built from the files ahead of time (embedded, SPIR-V), which it takes over.
+        // The files are read once they change.
+        ShaderReloader(ShaderFiles files, GLuint program);
+        ~ShaderReloader();
+        ShaderReloader(const ShaderReloader&) = delete;
+        ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+        // Starts watching, false without inotify or if no directory could be watched. The worker thread calls
+        // makeCurrent before its first build and doneCurrent when it stops: they make a context that shares objects
+        // with the render context current on it and release it again.
+        bool watch(ContextHook makeCurrent, ContextHook doneCurrent);
+
+        // Swaps in a rebuilt program that is ready to draw with, true if it did (uniform locations have to be looked
+        // up again). Never blocks on the worker or the driver.
+        bool update();
+
+        void use() const { glUseProgram(program_); }
+        GLuint program() const { return program_; }
+        // Whether the current program linked (false only if the files were broken from the start)
+        bool linked() const { return linked_; }
+
+        std::size_t reloads() const { return reloads_; }
+        std::size_t failures() const { return failures_; }
+
+    private:
+        // Reads the files and compiles them on the current context, 0 (and the error to std::cerr) if that fails
+        GLuint build(bool& linked) const;
+        void run(const ContextHook& makeCurrent, const ContextHook& doneCurrent);
+
+        ShaderFiles files_;
+        GLuint program_ = 0;
+        bool linked_ = false;
+        std::size_t reloads_ = 0;
+        std::atomic<std::size_t> failures_{0};
+
+        FileWatcher watcher_;
+        std::thread worker_;
+        std::atomic<bool> stop_{false};
+
+        // Built by the worker, not swapped in yet
+        std::mutex mutex_;
+        GLuint readyProgram_ = 0;
+        GLsync readyFence_ = nullptr;
+};
@@ -0,0 +1,68 @@
+#include "ShaderUtils.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Shader.hpp"
+#include "ShaderBuildQueue.hpp"
+
+// Function to read a shader file into source
+bool readShaderFile(const std::string& path, std::string& source) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Can't read shader file " << path << '\n';
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    source = contents.str();
+    return true;
+}
+
+// Function to create a shader program, see Shader (it comes from the active ProgramCache if there is one)
+GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+    return Shader(vertexSource, fragmentSource).release();
+}
+
+// Function to create a compute shader program (OpenGL 4.3)
+GLuint createComputeProgram(const char* computeSource) { return Shader(computeSource).release(); }
+
+// Function to create a shader program through the active ShaderBuildQueue, setup runs once it is linked
+GLuint buildShaderProgram(const char* vertexSource,
+                          const char* fragmentSource,
+                          const std::function<void(GLuint)>& setup,
+                          const std::string& name) {
+    return buildProgram({{GL_VERTEX_SHADER, vertexSource}, {GL_FRAGMENT_SHADER, fragmentSource}}, setup, name);
+}
+
+// Function to create a compute shader program through the active ShaderBuildQueue (OpenGL 4.3)
+GLuint buildComputeProgram(const char* computeSource,
+                           const std::function<void(GLuint)>& setup,
+                           const std::string& name) {
+    return buildProgram({{GL_COMPUTE_SHADER, computeSource}}, setup, name);
+}
+
+// Function to create a program of any stages through the active ShaderBuildQueue
+GLuint buildProgram(const ShaderStages& stages, const std::function<void(GLuint)>& setup, const std::string& name) {
+    if (ShaderBuildQueue* queue = ShaderBuildQueue::active()) return queue->submit(stages, setup, name);
+    GLuint program = Shader(stages, name).release();
+    if (setup) setup(program);
+    return program;
+}
+
+// Whether a program of buildShaderProgram can be drawn with
+bool shaderProgramReady(GLuint program) {
+    const ShaderBuildQueue* queue = ShaderBuildQueue::active();
+    return !queue || queue->ready(program);
+}
+
+// Whether a program of buildShaderProgram can't be drawn with
+bool shaderProgramFailed(GLuint program) {
+    if (program == 0) return true;
+    const ShaderBuildQueue* queue = ShaderBuildQueue::active();
+    if (queue) return queue->ready(program) && queue->failed(program);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked == GL_FALSE;
+}
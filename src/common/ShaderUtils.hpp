@@ -0,0 +1,40 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <functional>
+#include <string>
+
+#include "ProgramCache.hpp"
+
+// Function to read a shader file into source, false (and the reason to std::cerr) if it can't be read
+bool readShaderFile(const std::string& path, std::string& source);
+
+// Function to create a shader program, through Shader and with that the active ProgramCache
+GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource);
+
+// Function to create a compute shader program (OpenGL 4.3)
+GLuint createComputeProgram(const char* computeSource);
+
+// Function to create a shader program through the active ShaderBuildQueue. setup gets the linked program (block
+// bindings, sampler units, uniform locations), without a queue right away, with one once the driver is done. name
+// (a shader file, a permutation) goes into the compile and link errors.
+GLuint buildShaderProgram(const char* vertexSource,
+                          const char* fragmentSource,
+                          const std::function<void(GLuint)>& setup,
+                          const std::string& name = {});
+
+// Function to create a compute shader program through the active ShaderBuildQueue (OpenGL 4.3)
+GLuint buildComputeProgram(const char* computeSource,
+                           const std::function<void(GLuint)>& setup,
+                           const std::string& name = {});
+
+// Function to create a program of any stages through the active ShaderBuildQueue
+GLuint buildProgram(const ShaderStages& stages, const std::function<void(GLuint)>& setup, const std::string& name = {});
+
+// Whether a program of buildShaderProgram is done building, always true without a queue. It can be drawn with unless
+// shaderProgramFailed.
+bool shaderProgramReady(GLuint program);
+
+// Whether a program of buildShaderProgram is done and has compile or link errors (or is 0, nothing to build). False
+// while it is building.
+bool shaderProgramFailed(GLuint program);
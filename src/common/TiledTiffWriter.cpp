@@ -0,0 +1,212 @@
+#include "TiledTiffWriter.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    // BigTIFF field types
+    constexpr uint16_t typeAscii = 2;
+    constexpr uint16_t typeShort = 3;
+    constexpr uint16_t typeLong = 4;
+    constexpr uint16_t typeLong8 = 16;
+
+    constexpr uint64_t headerSize = 16;
+    constexpr uint64_t entryCount = 12;
+    constexpr uint64_t directorySize = 8 + entryCount * 20 + 8;
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+    bool validTileSize(uint32_t tileSize) { return tileSize != 0 && tileSize % 16 == 0; }
+
+    // Tiles along one side, none for a tile size the constructor rejects
+    uint32_t tilesCovering(uint32_t extent, uint32_t tileSize) {
+        return validTileSize(tileSize) ? (extent + tileSize - 1) / tileSize : 0;
+    }
+
+    // The tile offsets follow the description, NUL included
+    uint64_t tablesOffset(const std::string& description) {
+        return alignUp(headerSize + directorySize + description.size() + 1, 8);
+    }
+
+    // Little endian, independent of the host
+    void put(std::vector<char>& out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    // The value is either the data itself (if it fits into 8 bytes) or its offset
+    void putEntry(std::vector<char>& out, uint16_t tag, uint16_t type, uint64_t count, uint64_t value) {
+        put(out, tag, 2);
+        put(out, type, 2);
+        put(out, count, 8);
+        put(out, value, 8);
+    }
+
+    // Strings of up to 7 characters are stored in the entry
+    uint64_t packAscii(const std::string& text) {
+        uint64_t value = 0;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(text[i])) << (8 * i);
+        }
+        return value;
+    }
+}  // namespace
+
+TiledTiffWriter::TiledTiffWriter(const std::string& path,
+                                 uint32_t width,
+                                 uint32_t height,
+                                 uint32_t tileSize,
+                                 const std::string& description,
+                                 bool resume)
+    : path_(path),
+      journalPath_(path + ".journal"),
+      width_(width),
+      height_(height),
+      tileSize_(tileSize),
+      tilesAcross_(tilesCovering(width, tileSize)),
+      tilesDown_(tilesCovering(height, tileSize)),
+      done_(static_cast<std::size_t>(tilesAcross_) * tilesDown_, false) {
+    if (!validTileSize(tileSize)) {
+        std::cerr << "Tile size " << tileSize << " is not a multiple of 16\n";
+        return;
+    }
+    journalHeader_ = std::to_string(width) + " " + std::to_string(height) + " " + std::to_string(tileSize) + " " +
+                     description;
+
+    // Layout: header, directory, description, offset table, byte count table, tiles
+    dataOffset_ = alignUp(tablesOffset(description) + 2 * done_.size() * 8, 4096);
+
+    valid_ = (resume && resumeFromJournal()) || create(description);
+}
+
+TiledTiffWriter::~TiledTiffWriter() {
+    if (valid_) flush();
+}
+
+bool TiledTiffWriter::resumeFromJournal() {
+    std::ifstream journal(journalPath_);
+    std::string line;
+    if (!journal || !std::getline(journal, line) || line != journalHeader_) return false;
+
+    file_.open(path_, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file_) return false;
+
+    // A crash may have cut off the last line, only complete ones count. Anything that isn't a tile number ends the
+    // journal as well, those tiles are rendered again.
+    while (std::getline(journal, line) && !journal.eof()) {
+        std::size_t tile = 0;
+        auto [end, error] = std::from_chars(line.data(), line.data() + line.size(), tile);
+        if (error != std::errc() || end != line.data() + line.size()) break;
+        if (tile < done_.size() && !done_[tile]) {
+            done_[tile] = true;
+            doneCount_++;
+        }
+    }
+    journal.close();
+
+    // Written again with just the tiles that count, new ones would otherwise be appended to a cut off line
+    journal_.open(journalPath_, std::ios::trunc);
+    journal_ << journalHeader_ << '\n';
+    for (std::size_t tile = 0; tile < done_.size(); tile++) {
+        if (done_[tile]) journal_ << tile << '\n';
+    }
+    journal_.flush();
+    if (!journal_) {
+        std::cerr << "Failed to write " << journalPath_ << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool TiledTiffWriter::create(const std::string& description) {
+    file_.close();
+    file_.open(path_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        std::cerr << "Failed to create " << path_ << '\n';
+        return false;
+    }
+
+    const uint64_t tiles = done_.size();
+    const uint64_t tileBytes = static_cast<uint64_t>(tileSize_) * tileSize_;
+    const uint64_t descriptionOffset = headerSize + directorySize;
+    const uint64_t offsetsOffset = tablesOffset(description);
+    const uint64_t byteCountsOffset = offsetsOffset + tiles * 8;
+
+    std::vector<char> out;
+    out.insert(out.end(), {'I', 'I'});
+    put(out, 43, 2);  // BigTIFF
+    put(out, 8, 2);   // offset size
+    put(out, 0, 2);
+    put(out, headerSize, 8);
+
+    // Tags have to be sorted
+    put(out, entryCount, 8);
+    putEntry(out, 256, typeLong, 1, width_);               // ImageWidth
+    putEntry(out, 257, typeLong, 1, height_);              // ImageLength
+    putEntry(out, 258, typeShort, 1, 8);                   // BitsPerSample
+    putEntry(out, 259, typeShort, 1, 1);                   // Compression: none
+    putEntry(out, 262, typeShort, 1, 1);                   // PhotometricInterpretation: black is zero
+    putEntry(out, 270, typeAscii, description.size() + 1,  // ImageDescription
+             description.size() < 8 ? packAscii(description) : descriptionOffset);
+    putEntry(out, 277, typeShort, 1, 1);                   // SamplesPerPixel
+    putEntry(out, 284, typeShort, 1, 1);                   // PlanarConfiguration: chunky
+    putEntry(out, 322, typeLong, 1, tileSize_);            // TileWidth
+    putEntry(out, 323, typeLong, 1, tileSize_);            // TileLength
+    // TileOffsets and TileByteCounts, a single tile fits into the entry
+    putEntry(out, 324, typeLong8, tiles, tiles == 1 ? dataOffset_ : offsetsOffset);
+    putEntry(out, 325, typeLong8, tiles, tiles == 1 ? tileBytes : byteCountsOffset);
+    put(out, 0, 8);                                        // no next directory
+
+    out.insert(out.end(), description.begin(), description.end());
+    out.push_back('\0');
+    out.resize(offsetsOffset, '\0');
+    for (uint64_t i = 0; i < tiles; i++) put(out, dataOffset_ + i * tileBytes, 8);
+    for (uint64_t i = 0; i < tiles; i++) put(out, tileBytes, 8);
+    file_.write(out.data(), static_cast<std::streamsize>(out.size()));
+
+    // Journal after the image, a journal always belongs to a complete header
+    file_.flush();
+    journal_.open(journalPath_, std::ios::trunc);
+    journal_ << journalHeader_ << '\n';
+    journal_.flush();
+    if (!file_ || !journal_) {
+        std::cerr << "Failed to write " << path_ << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool TiledTiffWriter::writeTile(uint32_t column, uint32_t row, const uint8_t* pixels) {
+    const std::size_t tile = index(column, row);
+    const uint64_t tileBytes = static_cast<uint64_t>(tileSize_) * tileSize_;
+    file_.seekp(static_cast<std::streamoff>(dataOffset_ + tile * tileBytes));
+    file_.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(tileBytes));
+    if (!file_) {
+        std::cerr << "Failed to write tile " << column << ", " << row << " to " << path_ << '\n';
+        return false;
+    }
+    if (!done_[tile]) {
+        done_[tile] = true;
+        doneCount_++;
+    }
+    unjournaled_.push_back(tile);
+    return true;
+}
+
+void TiledTiffWriter::flush() {
+    file_.flush();
+    if (!file_) return;
+    for (std::size_t tile : unjournaled_) journal_ << tile << '\n';
+    journal_.flush();
+    unjournaled_.clear();
+}
+
+bool TiledTiffWriter::finish() {
+    flush();
+    bool ok = static_cast<bool>(file_) && static_cast<bool>(journal_);
+    if (ok && doneCount_ == done_.size()) {
+        journal_.close();
+        std::remove(journalPath_.c_str());
+    }
+    return ok;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// 8 bit grayscale BigTIFF made of square uncompressed tiles that can be written in any order. Header, directory and
+// tile tables are written when the file is created, so every tile has a fixed place in the file and memory use
+// doesn't depend on the image size.
+//
+// Finished tiles are recorded in a journal next to the image (path + ".journal") whose first line is the description.
+// Opening an image with resume set and a journal with the same description continues where the last run stopped.
+class TiledTiffWriter {
+    public:
+        // tileSize has to be a multiple of 16 (TIFF requirement)
+        TiledTiffWriter(const std::string& path,
+                        uint32_t width,
+                        uint32_t height,
+                        uint32_t tileSize,
+                        const std::string& description,
+                        bool resume);
+        ~TiledTiffWriter();
+        TiledTiffWriter(const TiledTiffWriter&) = delete;
+        TiledTiffWriter& operator=(const TiledTiffWriter&) = delete;
+
+        // false if the file couldn't be created, the reason went to std::cerr
+        bool valid() const { return valid_; }
+
+        uint32_t tilesAcross() const { return tilesAcross_; }
+        uint32_t tilesDown() const { return tilesDown_; }
+        std::size_t tileCount() const { return done_.size(); }
+        std::size_t doneTiles() const { return doneCount_; }
+        bool tileDone(uint32_t column, uint32_t row) const { return done_[index(column, row)]; }
+
+        // tileSize * tileSize pixels, top row first. Pixels outside the image are stored but never shown.
+        bool writeTile(uint32_t column, uint32_t row, const uint8_t* pixels);
+
+        // Flushes the image and then records the tiles written since the last call in the journal. A tile is only
+        // journaled once its pixels left the process, so a crash can at most lose tiles that get rendered again.
+        void flush();
+
+        // Flushes and deletes the journal if every tile is done. Returns false if a write failed.
+        bool finish();
+
+    private:
+        std::size_t index(uint32_t column, uint32_t row) const {
+            return static_cast<std::size_t>(row) * tilesAcross_ + column;
+        }
+        bool create(const std::string& description);
+        bool resumeFromJournal();
+
+        std::string path_;
+        std::string journalPath_;
+        uint32_t width_;
+        uint32_t height_;
+        uint32_t tileSize_;
+        uint32_t tilesAcross_;
+        uint32_t tilesDown_;
+        uint64_t dataOffset_ = 0;  // first tile, the others follow in index order
+        std::fstream file_;
+        std::ofstream journal_;
+        std::vector<bool> done_;
+        std::size_t doneCount_ = 0;
+        std::vector<std::size_t> unjournaled_;
+        std::string journalHeader_;  // size, tile size and description, a resume has to match all of them
+        bool valid_ = false;
+};
@@ -0,0 +1,72 @@
+#include "UniformBinding.hpp"
+
+#include <cstring>
+
+namespace {
+    uint32_t bitsOf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+}
+
+UniformBinding::UniformBinding(GLuint program) {
+    GLint count = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> name(maxNameLength + 1);
+    for (GLint i = 0; i < count; i++) {
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(program, i, static_cast<GLsizei>(name.size()), nullptr, &size, &type, name.data());
+
+        // Members of uniform blocks have no location
+        GLint location = glGetUniformLocation(program, name.data());
+        if (location < 0) continue;
+
+        std::string uniformName = name.data();
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+            uniformName.resize(uniformName.size() - 3);  // arrays are reported as name[0]
+        }
+        locations_[uniformName] = location;
+        if (location >= static_cast<GLint>(shadows_.size())) shadows_.resize(location + 1);
+    }
+}
+
+GLint UniformBinding::location(const std::string& name) const {
+    auto it = locations_.find(name);
+    return it == locations_.end() ? -1 : it->second;
+}
+
+void UniformBinding::set(GLint location, int x) {
+    if (changed(location, static_cast<uint32_t>(x), 0)) glUniform1i(location, x);
+}
+
+void UniformBinding::set(GLint location, int x, int y) {
+    if (changed(location, static_cast<uint32_t>(x), static_cast<uint32_t>(y))) glUniform2i(location, x, y);
+}
+
+void UniformBinding::set(GLint location, float x) {
+    if (changed(location, bitsOf(x), 0)) glUniform1f(location, x);
+}
+
+void UniformBinding::set(GLint location, float x, float y) {
+    if (changed(location, bitsOf(x), bitsOf(y))) glUniform2f(location, x, y);
+}
+
+bool UniformBinding::changed(GLint location, uint32_t x, uint32_t y) {
+    if (location < 0 || location >= static_cast<GLint>(shadows_.size())) return false;
+
+    // Compare bits, not values: NaN never equals itself and -0.0 equals 0.0
+    Shadow& shadow = shadows_[location];
+    if (shadow.valid && shadow.bits[0] == x && shadow.bits[1] == y) {
+        skippedCalls_++;
+        return false;
+    }
+    shadow.bits = {x, y};
+    shadow.valid = true;
+    issuedCalls_++;
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Resolves all uniform locations of a linked program once and keeps a CPU-side copy of every value that was set.
+// glUniform* is only called when a value actually changes. Like glUniform*, set expects the program to be in use.
+class UniformBinding {
+    public:
+        explicit UniformBinding(GLuint program);
+
+        // -1 for unknown names (or uniforms the linker removed), setting those is a no-op like in OpenGL
+        GLint location(const std::string& name) const;
+
+        void set(GLint location, int x);
+        void set(GLint location, int x, int y);
+        void set(GLint location, float x);
+        void set(GLint location, float x, float y);
+
+        std::size_t issuedCalls() const { return issuedCalls_; }
+        std::size_t skippedCalls() const { return skippedCalls_; }
+
+    private:
+        struct Shadow {
+            std::array<uint32_t, 2> bits{};
+            bool valid = false;
+        };
+
+        // true if the value differs from the shadow (which is then updated)
+        bool changed(GLint location, uint32_t x, uint32_t y);
+
+        std::unordered_map<std::string, GLint> locations_;
+        std::vector<Shadow> shadows_;  // indexed by location
+        std::size_t issuedCalls_ = 0;
+        std::size_t skippedCalls_ = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstring>
+
+// Uniform buffer object holding one std140 block. Block has to be a standard layout struct that mirrors the
+// std140 layout of the GLSL block (including padding). update only touches the buffer if the contents changed.
+template <typename Block>
+class UniformBuffer {
+    public:
+        explicit UniformBuffer(GLuint bindingPoint) : bindingPoint_(bindingPoint) {
+            glGenBuffers(1, &buffer_);
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint_, buffer_);
+        }
+        ~UniformBuffer() { glDeleteBuffers(1, &buffer_); }
+        UniformBuffer(const UniformBuffer&) = delete;
+        UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+        // Connects the named block of the program to this buffer
+        void attach(GLuint program, const char* blockName) const {
+            GLuint index = glGetUniformBlockIndex(program, blockName);
+            if (index != GL_INVALID_INDEX) glUniformBlockBinding(program, index, bindingPoint_);
+        }
+
+        // Uploads block if it differs from the last upload, returns whether it did
+        bool update(const Block& block) {
+            if (valid_ && std::memcmp(&shadow_, &block, sizeof(Block)) == 0) {
+                skippedUpdates_++;
+                return false;
+            }
+            shadow_ = block;
+            valid_ = true;
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            updates_++;
+            return true;
+        }
+
+        std::size_t updates() const { return updates_; }
+        std::size_t skippedUpdates() const { return skippedUpdates_; }
+
+    private:
+        GLuint buffer_ = 0;
+        GLuint bindingPoint_;
+        Block shadow_{};
+        bool valid_ = false;
+        std::size_t updates_ = 0;
+        std::size_t skippedUpdates_ = 0;
+};